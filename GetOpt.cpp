@@ -46,19 +46,617 @@
 #include <stdio.h>
 #endif
 
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>             // Only mem* if GETOPT_FREESTANDING
+
+#ifndef GETOPT_NO_STRTOD
+#include <errno.h>
+#include <locale.h>
+#include <math.h>
+#endif
+
+#ifndef GETOPT_FREESTANDING
 #include <stdlib.h>
-#include <string.h>
+#endif
+
+#ifndef GETOPT_NO_FILES
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifndef GETOPT_NO_THREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#if defined(GETOPT_STATS) && !defined(GETOPT_FREESTANDING)
+#include <time.h>
+#endif
 
 #include "GetOpt.hpp"
 
+// The SSE2 code reads past the end of an argument (see readDigits),
+// which AddressSanitizer would report:
+#if defined(__SANITIZE_ADDRESS__)
+#define GETOPT_ASAN
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define GETOPT_ASAN
+#endif
+#endif
+
+#if defined(__SSE2__) && !defined(GETOPT_NO_SIMD) && \
+    !defined(GETOPT_NO_NUMBERS) && !defined(GETOPT_ASAN)
+#include <emmintrin.h>
+#define GETOPT_SSE2
+#endif
+
 static const char longOptionStart[] = "--";
 
+// The posArg returned by nextOption when the possible argument comes
+// from the current ArgSource instead of argv:
+static const int  fromSource = -1;
+
+// The maximum number of response files that may be open at once
+// (which is how deeply they may be nested):
+static const int  maxSourceDepth = 32;
+
+
+// How deeply commands may be nested (see Subcommands):
+static const int  maxCommandDepth = 8;
+
+#ifndef GETOPT_NO_THREADS
+// The most threads that convert arguments at once, and how many
+// arguments a thread takes at a time (see Parallel conversion):
+static const int  maxConversionThreads = 64;
+static const int  conversionBatch = 16;
+#endif
+
+// Freeing what was allocated before an allocation failed needs
+// exceptions.  Built without them (as with -fno-exceptions), new
+// can't fail, so the cleanup is never needed:
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define GETOPT_TRY        try
+#define GETOPT_CATCH_ALL  catch (...)
+#define GETOPT_RETHROW    throw
+#else
+#define GETOPT_TRY        if (true)
+#define GETOPT_CATCH_ALL  else
+#define GETOPT_RETHROW
+#endif
+
+// Counting for GETOPT_STATS (see Instrumentation), which is compiled
+// only when it's wanted:
+#ifdef GETOPT_STATS
+#define GETOPT_COUNT(expression)  (expression)
+#else
+#define GETOPT_COUNT(expression)  ((void) 0)
+#endif
+
+//====================================================================
+// String functions:
+//
+// The only string functions GetOpt uses.  Normally they're the C
+// library's, but a freestanding build (GETOPT_FREESTANDING) can't
+// count on having those, so it has its own.  Nothing here is used to
+// scan much text, so simple loops are fast enough.
+//--------------------------------------------------------------------
+
+#ifdef GETOPT_FREESTANDING
+static size_t textLength(const char* s)
+{
+  const char*  e = s;
+  while (*e) ++e;
+  return e - s;
+}
+
+// Like strchr, this finds the NUL that ends s if c is 0:
+static const char* findChar(const char* s, char c)
+{
+  for (;; ++s) {
+    if (*s == c) return s;
+    if (!*s) return NULL;
+  }
+}
+
+static bool sameText(const char* a, const char* b)
+{
+  while (*a && *a == *b) {
+    ++a; ++b;
+  }
+  return *a == *b;
+}
+
+static bool startsWith(const char* s, const char* prefix)
+{
+  while (*prefix)
+    if (*s++ != *prefix++) return false;
+  return true;
+}
+
+// Returns the end of the copy (where its NUL is):
+static char* copyText(char* to, const char* from)
+{
+  while ((*to = *from++) != 0) ++to;
+  return to;
+}
+#else // use the C library
+static inline size_t textLength(const char* s) { return strlen(s); }
+
+static inline const char* findChar(const char* s, char c)
+{
+  return strchr(s, c);
+}
+
+static inline bool sameText(const char* a, const char* b)
+{
+  return !strcmp(a, b);
+}
+
+static inline bool startsWith(const char* s, const char* prefix)
+{
+  return !strncmp(s, prefix, strlen(prefix));
+}
+
+static inline char* copyText(char* to, const char* from)
+{
+  const size_t  length = strlen(from);
+  memcpy(to, from, length + 1);
+  return to + length;
+}
+#endif // not GETOPT_FREESTANDING
+
+//====================================================================
+// Growing an argument list:
+//
+// skipped and sourceArg are each kept with a list of ints alongside.
+// This doubles the room in both (or makes room for 64 entries),
+// keeping the first count entries.  Neither changes if new throws.
+//--------------------------------------------------------------------
+
+static void growArgList(const char**& list, int*& ints, int count,
+                        int& size)
+{
+  const int     newSize = size ? 2 * size : 64;
+  const char**  newList = new const char*[newSize];
+  int*          newInts;
+  GETOPT_TRY {
+    newInts = new int[newSize];
+  } GETOPT_CATCH_ALL {
+    delete [] newList;
+    GETOPT_RETHROW;
+  }
+  if (count) {
+    memcpy(newList, list, count * sizeof(*list));
+    memcpy(newInts, ints, count * sizeof(*ints));
+  }
+  delete [] list;
+  delete [] ints;
+  list = newList;
+  ints = newInts;
+  size = newSize;
+} // end growArgList
+
+#ifndef GETOPT_NO_NUMBERS
+//====================================================================
+// Locale-independent number parsing:
+//
+// These are used by the numeric callbacks below.  Unlike strtol and
+// strtod, they never look at the locale, and they detect overflow
+// without errno.
+//
+// Each parser reads a number at the beginning of p and returns a
+// pointer to the first character it didn't use, or NULL if p doesn't
+// begin with a number.  If the number doesn't fit, overflow is set to
+// true.
+//--------------------------------------------------------------------
+
+union Number
+{
+  int64_t   i;
+  uint64_t  u;
+  double    d;
+}; // end Number
+
+typedef const char* (NumberParser)(const char* p, Number& result,
+                                   bool& overflow);
+
+static const uint64_t  maxUInt64 = ~static_cast<uint64_t>(0);
+static const uint64_t  maxInt64  = maxUInt64 >> 1;
+
+//--------------------------------------------------------------------
+// Return the value of a digit, or 99 if c is not a digit in base:
+
+static inline unsigned digitValue(char c, unsigned base)
+{
+  unsigned  d = 99;
+
+  if (c >= '0' && c <= '9')
+    d = c - '0';
+  else if (base == 16 && (c | 0x20) >= 'a' && (c | 0x20) <= 'f')
+    d = (c | 0x20) - 'a' + 10;
+
+  return (d < base) ? d : 99;
+} // end digitValue
+
+//--------------------------------------------------------------------
+// Parse an unsigned integer (decimal, or hex with a 0x prefix if
+// allowHex is true):
+
+static const char* parseUnsigned(const char* p, uint64_t& value,
+                                 bool& overflow, bool allowHex = true)
+{
+  unsigned  base = 10;
+
+  if (allowHex && p[0] == '0' && (p[1] | 0x20) == 'x' &&
+      digitValue(p[2], 16) < 16) {
+    base = 16;
+    p += 2;
+  }
+
+  if (digitValue(*p, base) >= base) return NULL;
+
+  value = 0;
+  for (unsigned d; (d = digitValue(*p, base)) < base; ++p) {
+    if (value > (maxUInt64 - d) / base)
+      overflow = true;
+    else
+      value = value * base + d;
+  }
+
+  return p;
+} // end parseUnsigned
+
+//--------------------------------------------------------------------
+// Parse a signed 64-bit integer:
+
+static const char* parseInt64(const char* p, Number& result,
+                              bool& overflow)
+{
+  const bool  negative = (*p == '-');
+  if (*p == '-' || *p == '+') ++p;
+
+  uint64_t  magnitude = 0;
+  if (!(p = parseUnsigned(p, magnitude, overflow))) return NULL;
+
+  if (magnitude > maxInt64 + negative)
+    overflow = true;
+  else if (negative)
+    result.i = (magnitude == maxInt64 + 1)
+      ? -static_cast<int64_t>(maxInt64) - 1
+      : -static_cast<int64_t>(magnitude);
+  else
+    result.i = static_cast<int64_t>(magnitude);
+
+  return p;
+} // end parseInt64
+
+//--------------------------------------------------------------------
+// Parse an unsigned 64-bit integer:
+
+static const char* parseUInt64(const char* p, Number& result,
+                               bool& overflow)
+{
+  if (*p == '+') ++p;
+
+  return parseUnsigned(p, result.u, overflow);
+} // end parseUInt64
+
+#ifndef GETOPT_NO_STRTOD
+//--------------------------------------------------------------------
+// Parse a floating-point number:
+//
+// This accepts an optional sign, digits with an optional decimal
+// point (always '.'), an optional exponent, or "inf", "infinity" or
+// "nan" in any case.  The result is the closest double, so a number
+// printed with enough digits reads back exactly.
+//
+// Most numbers have no more than 19 significant digits and a small
+// exponent, and those are converted exactly right here.  Anything
+// else goes to strtod, which is correctly rounded but has to be given
+// the locale's decimal point.
+
+static const char* parseDouble(const char* p, Number& result,
+                               bool& overflow)
+{
+  // Powers of ten that are exactly representable as a double:
+  static const double  pow10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10,
+    1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21,
+    1e22
+  };
+
+  const bool  negative = (*p == '-');
+  if (*p == '-' || *p == '+') ++p;
+
+  const char* const  start = p;
+
+  // Infinity and NaN:
+  static const char* const  words[] = { "infinity", "inf", "nan" };
+  for (int w = 0; w < 3; ++w) {
+    int  n = 0;
+    while (words[w][n] && (p[n] | 0x20) == words[w][n]) ++n;
+    if (!words[w][n]) {
+      result.d = (w < 2) ? HUGE_VAL : (HUGE_VAL - HUGE_VAL);
+      if (negative) result.d = -result.d;
+      return p + n;
+    }
+  } // end for each special word
+
+  // Below this, another digit can't overflow the mantissa:
+  static const uint64_t  bigMantissa =
+    static_cast<uint64_t>(1000000000) * 1000000000;
+
+  uint64_t  mantissa = 0;
+  int       exp10 = 0;
+  bool      exact = true, any = false;
+  unsigned  d;
+
+  for (; (d = digitValue(*p, 10)) < 10; ++p) {
+    any = true;
+    if (mantissa < bigMantissa)
+      mantissa = mantissa * 10 + d;
+    else {
+      ++exp10;                  // Too many digits, drop this one
+      if (d) exact = false;
+    }
+  } // end for each digit before the decimal point
+
+  if (*p == '.') {
+    while ((d = digitValue(*++p, 10)) < 10) {
+      any = true;
+      if (mantissa < bigMantissa) {
+        mantissa = mantissa * 10 + d;
+        --exp10;
+      } else if (d)
+        exact = false;
+    }
+  } // end if decimal point
+
+  if (!any) return NULL;
+
+  if ((*p | 0x20) == 'e') {
+    const char*  e = p + 1;
+    const bool   negExp = (*e == '-');
+    if (*e == '-' || *e == '+') ++e;
+
+    if (digitValue(*e, 10) < 10) {
+      int  exponent = 0;
+      for (; (d = digitValue(*e, 10)) < 10; ++e)
+        if (exponent < 100000) exponent = exponent * 10 + d;
+      exp10 += negExp ? -exponent : exponent;
+      p = e;
+    } // else the 'e' is not part of the number
+  } // end if exponent
+
+  if (exact && mantissa <= (static_cast<uint64_t>(1) << 53) &&
+      exp10 >= -22 && exp10 <= 22) {
+    // Both operands are exact, so one rounding gives the right answer:
+    result.d = static_cast<double>(mantissa);
+    if (exp10 < 0)
+      result.d /= pow10[-exp10];
+    else
+      result.d *= pow10[exp10];
+  } else {
+    // Let strtod do it, with the decimal point it expects:
+    const char* const  point = localeconv()->decimal_point;
+    const size_t       pointLen = textLength(point);
+    const size_t       size = (p - start) * (pointLen + 1) + 1;
+    char   local[128];
+    char*  copy = (size <= sizeof(local)) ? local : new char[size];
+    char*  out = copy;
+
+    for (const char* in = start; in < p; ++in) {
+      if (*in == '.') {
+        memcpy(out, point, pointLen);
+        out += pointLen;
+      } else
+        *out++ = *in;
+    }
+    *out = 0;
+
+    result.d = strtod(copy, NULL);
+    if (copy != local) delete [] copy;
+  } // end else let strtod do it
+
+  if (result.d == HUGE_VAL || result.d == -HUGE_VAL)
+    overflow = true;
+
+  if (negative) result.d = -result.d;
+  return p;
+} // end parseDouble
+#endif // not GETOPT_NO_STRTOD
+
+//--------------------------------------------------------------------
+// Parse a byte count with an optional unit:
+//
+// The units are K, M, G, T, P and E (powers of 1000) or Ki, Mi, Gi,
+// Ti, Pi and Ei (powers of 1024), in any case, optionally followed
+// by B.  The number itself must be an integer.
+
+static const char* parseByteSize(const char* p, Number& result,
+                                 bool& overflow)
+{
+  static const char  units[] = "kmgtpe";
+
+  if (*p == '+') ++p;
+  if (!(p = parseUnsigned(p, result.u, overflow))) return NULL;
+
+  const char* const  unit = findChar(units, *p | 0x20);
+  if (*p && unit) {
+    uint64_t  scale = 1000;
+    ++p;
+    if ((*p | 0x20) == 'i') {
+      scale = 1024;
+      ++p;
+    }
+
+    for (const char* u = units; u <= unit; ++u) {
+      if (result.u > maxUInt64 / scale)
+        overflow = true;
+      else
+        result.u *= scale;
+    }
+  } // end if unit
+
+  if ((*p | 0x20) == 'b') ++p;
+
+  return p;
+} // end parseByteSize
+
+//--------------------------------------------------------------------
+// Parse a duration, giving milliseconds:
+//
+// A duration is one or more numbers, each followed by a unit: ms, s,
+// m or h.  A single number without a unit is in seconds.  Numbers
+// may have a fractional part, as in "1.5s" or "1h30m"; the result is
+// rounded down to a whole millisecond.
+
+static const char* parseDuration(const char* p, Number& result,
+                                 bool& overflow)
+{
+  uint64_t  total = 0;
+  bool      any = false;
+
+  if (*p == '+') ++p;
+
+  for (;;) {
+    uint64_t  whole = 0;
+    const char*  q = parseUnsigned(p, whole, overflow, false);
+    if (!q) break;
+
+    // Up to 9 digits of fraction, as a count of nanounits:
+    uint64_t  fraction = 0, scale = 1000000000;
+    if (*q == '.') {
+      while (digitValue(*++q, 10) < 10) {
+        if (scale > 1) {
+          scale /= 10;
+          fraction += (*q - '0') * scale;
+        }
+      }
+    } // end if fraction
+
+    uint64_t  unit;             // milliseconds per unit
+    if (q[0] == 'm' && q[1] == 's')
+      unit = 1, q += 2;
+    else if (*q == 's')
+      unit = 1000, ++q;
+    else if (*q == 'm')
+      unit = 60 * 1000, ++q;
+    else if (*q == 'h')
+      unit = 60 * 60 * 1000, ++q;
+    else if (!any)
+      unit = 1000;              // a bare number is in seconds
+    else
+      break;                    // not part of the duration
+
+    if (whole > (maxInt64 - total) / unit)
+      overflow = true;
+    else
+      total += whole * unit + fraction * unit / 1000000000;
+
+    any = true;
+    p = q;
+    if (digitValue(*p, 10) >= 10) break;
+  } // end forever
+
+  if (!any) return NULL;
+
+  if (total > maxInt64) overflow = true;
+  result.i = static_cast<int64_t>(total);
+
+  return p;
+} // end parseDuration
+
+//--------------------------------------------------------------------
+// Check the number found by a parser:
+//
+// Input:
+//   getopt, asEntered, connected, argument, usedChars:
+//     As passed to the callback
+//   end, overflow:
+//     As set by the parser
+//   message:
+//     The error message for an argument that isn't a number
+//
+// Returns:
+//   true if the number should be stored (*usedChars has been set if
+//   only part of the argument was used), or false if not (an error
+//   has been reported if the argument was not another option)
+
+static bool checkNumber(GetOpt* getopt, const char* asEntered,
+                        GetOpt::Connection connected,
+                        const char* argument, int* usedChars,
+                        const char* end, bool overflow,
+                        const char* message)
+{
+  if (!end || (*end && !usedChars)) {
+    // In a bundle like -vx, x is just another option:
+    if (!end && connected == GetOpt::adjacent) return false;
+
+    getopt->reportError(asEntered, message);
+    return false;
+  }
+
+  if (overflow) {
+    getopt->reportError(asEntered, " has an argument that is out of range");
+    return false;
+  }
+
+  if (*end) *usedChars = end - argument;
+
+  return true;
+} // end checkNumber
+
+//--------------------------------------------------------------------
+// Do the work of a numeric callback:
+//
+// This works like the standard callbacks, except that it also needs:
+//   parse:    The parser for this kind of number
+//   size:     The size of the variable that option->data points to
+//   message:  The error message for an argument that isn't a number
+//
+// The variable is changed only if the argument is valid.  If usedChars
+// is not NULL, a number at the beginning of a bundle is used and the
+// rest of the bundle is left for other options.
+
+static bool convertNumber(GetOpt* getopt, const GetOpt::Option* option,
+                          const char* asEntered,
+                          GetOpt::Connection connected,
+                          const char* argument, int* usedChars,
+                          NumberParser* parse, size_t size,
+                          const char* message)
+{
+  if (!argument ||
+      ((connected == GetOpt::nextArg) && !(option->flag & GetOpt::needArg)))
+    return false; // No argument or non-connected optional argument
+
+  Number  result = Number();
+  bool    overflow = false;
+  const char* const  end = (*parse)(argument, result, overflow);
+
+  if (!checkNumber(getopt, asEntered, connected, argument, usedChars,
+                   end, overflow, message))
+    return false;
+
+  memcpy(getopt->optionData(option), &result, size);
+
+  return true;
+} // end convertNumber
+#endif // not GETOPT_NO_NUMBERS
+
 //====================================================================
 // Standard argument callback functions:
 //
 // An argument callback function is called when GetOpt finds the
 // option that specified it.  The usual behavior is to validate the
-// argument and copy it to the location specified by option->data.
+// argument and copy it to the location specified by option->data
+// (or rather getopt->optionData(option), which is the same thing
+// unless the option has the inResults flag).
 // However, the function can do anything it wants.  It should return
 // true if it found an argument, or false if it did not.
 //
@@ -111,17 +709,19 @@ static const char longOptionStart[] = "--";
 //
 // option->data must point to a double.
 
+#ifndef GETOPT_NO_STRTOD
 bool GetOpt::isFloat(GetOpt* getopt, const Option* option,
                      const char* asEntered,
                      Connection connected, const char* argument,
-                     int* usedChars)
+                     int* /*usedChars*/)
 {
   if (!argument ||
       ((connected == nextArg) && !(option->flag & GetOpt::needArg)))
     return false; // No argument or non-connected optional argument
 
   char*  end;
-  *reinterpret_cast<double*>(option->data) = strtod(argument, &end);
+  *reinterpret_cast<double*>(getopt->optionData(option)) =
+    strtod(argument, &end);
 
   if (*end) {
     getopt->reportError(asEntered, " requires a numeric argument");
@@ -139,14 +739,15 @@ bool GetOpt::isFloat(GetOpt* getopt, const Option* option,
 bool GetOpt::isLong(GetOpt* getopt, const Option* option,
                    const char* asEntered,
                    Connection connected, const char* argument,
-                   int* usedChars)
+                   int* /*usedChars*/)
 {
   if (!argument ||
       ((connected == nextArg) && !(option->flag & GetOpt::needArg)))
     return false; // No argument or non-connected optional argument
 
   char*  end;
-  *reinterpret_cast<long*>(option->data) = strtol(argument, &end, 0);
+  *reinterpret_cast<long*>(getopt->optionData(option)) =
+    strtol(argument, &end, 0);
 
   if (*end) {
     getopt->reportError(asEntered, " requires an integer argument");
@@ -155,6 +756,7 @@ bool GetOpt::isLong(GetOpt* getopt, const Option* option,
 
   return true;
 } // end GetOpt::isLong
+#endif // not GETOPT_NO_STRTOD
 
 //--------------------------------------------------------------------
 // Process a string argument:
@@ -162,92 +764,4279 @@ bool GetOpt::isLong(GetOpt* getopt, const Option* option,
 // option->data must point to a const char*.
 
 bool GetOpt::isString(GetOpt* getopt, const Option* option,
-                   const char* asEntered,
+                   const char* /*asEntered*/,
                    Connection connected, const char* argument,
-                   int* usedChars)
+                   int* /*usedChars*/)
 {
   if (!argument ||
       ((connected == nextArg) && !(option->flag & GetOpt::needArg)))
     return false; // No argument or non-connected optional argument
 
-  if (option->data)
-    *reinterpret_cast<const char**>(option->data) = argument;
+  void* const  data = getopt->optionData(option);
+  if (data)
+    *reinterpret_cast<const char**>(data) = argument;
 
   return true;
 } // end GetOpt::isString
 
-//====================================================================
-// Class GetOpt:
-//
-// Member Variables:
-//   error:
-//     true if an error has occurred during option processing
-//     false if everything is ok
-//   errorOutput:
-//     A function which is called to display errors
-//     Set to GetOpt::printError by the GetOpt constructor.
-//     If NULL, errors are reported only by setting error to true.
-//   optionStart:
-//     A string containing the characters that indicate options
-//     Set to "-" by the GetOpt constructor.
-//     Must contain '-' if you expect long options to work.
-//     This applies only to single-character options; "--" is always
-//     the long option indicator.
-//     Programs that want to accept DOS-style options should set this
-//     to "-/".  Note that this string is not disposed of by the
-//     GetOpt object.  It must continue to exist as long as the GetOpt
-//     object does.  (Normally, you would set it to point to a string
-//     literal.)
-//
-// Protected Member Variables:
-//   optionList:
-//     The array of GetOpt::Option objects passed to the constructor
-//   argc, argv:
-//     The parameters passed to main (or similar)
-//   argi:
-//     The index in argv of the argument currently being processed
-//   chari:
-//     If non-zero, the index in argv[argi] of the option character
-//     currently being processed (for single-character option bundles).
-//   normalOnly:
-//     True means that all arguments yet to be processed are not options.
-//   returningAll:
-//     Points to the GetOpt::Option that corresponds to normal
-//     non-option arguments, or NULL if GetOpt is to process only
-//     options.
-//   shortOptionBuf:
-//     Used when processing single-character option bundles
-//
 //--------------------------------------------------------------------
-// Constructor:
+// Process a 64-bit integer argument:
 //
-// Input:
-//   aList:
-//     An array of GetOpt::Option objects that define the options to
-//     look for.  This array is not copied, and must continue to exist
-//     as long as the GetOpt object does.
+// These do not depend on the locale, and they report an error if the
+// number doesn't fit.  The number may be decimal or hex (with 0x).
+// In a bundle of single-character options, a number right after the
+// option is its argument and anything after that is more options
+// (so -n5v is the same as -n 5 -v).
+//
+// For isInt64, option->data must point to an int64_t.
+// For isUInt64, option->data must point to a uint64_t.
 
-GetOpt::GetOpt(const Option* aList)
-: error(false),
-#ifdef GETOPT_NO_STDIO
-  errorOutput(NULL),               // No stdio, can't print errors
-#else
-  errorOutput(GetOpt::printError), // Print error messages to stderr
-#endif
-  optionStart("-"),
-  optionList(aList),
-  argc(0),
-  argi(0), chari(0),
-  argv(NULL),
-  normalOnly(false)
+#ifndef GETOPT_NO_NUMBERS
+bool GetOpt::isInt64(GetOpt* getopt, const Option* option,
+                     const char* asEntered,
+                     Connection connected, const char* argument,
+                     int* usedChars)
 {
-  checkReturnAll();
-} // end GetOpt::GetOpt
+  return convertNumber(getopt, option, asEntered, connected, argument,
+                       usedChars, parseInt64, sizeof(int64_t),
+                       " requires an integer argument");
+} // end GetOpt::isInt64
+
+bool GetOpt::isUInt64(GetOpt* getopt, const Option* option,
+                      const char* asEntered,
+                      Connection connected, const char* argument,
+                      int* usedChars)
+{
+  return convertNumber(getopt, option, asEntered, connected, argument,
+                       usedChars, parseUInt64, sizeof(uint64_t),
+                       " requires a non-negative integer argument");
+} // end GetOpt::isUInt64
 
 //--------------------------------------------------------------------
-// Standard callback function for printing error messages:
+// Process a floating-point argument without using the locale:
 //
-// You should generally not call this function directly.  Use
+// Unlike isFloat, the decimal point is always '.', and a number that
+// is too big for a double is an error.  The value is the closest
+// double to the number entered, so printing a double with 17
+// significant digits and reading it back gives the same double.
+//
+// option->data must point to a double.
+
+#ifndef GETOPT_NO_STRTOD
+bool GetOpt::isDouble(GetOpt* getopt, const Option* option,
+                      const char* asEntered,
+                      Connection connected, const char* argument,
+                      int* usedChars)
+{
+  return convertNumber(getopt, option, asEntered, connected, argument,
+                       usedChars, parseDouble, sizeof(double),
+                       " requires a numeric argument");
+} // end GetOpt::isDouble
+#endif // not GETOPT_NO_STRTOD
+
+//--------------------------------------------------------------------
+// Process a size in bytes:
+//
+// The argument is an integer with an optional unit: K, M, G, T, P or
+// E for powers of 1000, or Ki, Mi, Gi, Ti, Pi or Ei for powers of
+// 1024.  Units are not case sensitive, and may be followed by B.  So
+// 4k, 4KB and 4000 are all the same, and 4Ki is 4096.
+//
+// option->data must point to a uint64_t.
+
+bool GetOpt::isByteSize(GetOpt* getopt, const Option* option,
+                        const char* asEntered,
+                        Connection connected, const char* argument,
+                        int* usedChars)
+{
+  return convertNumber(getopt, option, asEntered, connected, argument,
+                       usedChars, parseByteSize, sizeof(uint64_t),
+                       " requires a size (like 512, 64K or 2Gi)");
+} // end GetOpt::isByteSize
+
+//--------------------------------------------------------------------
+// Process a duration:
+//
+// The argument is one or more numbers with units: ms, s, m or h (for
+// example, 250ms, 1.5s or 1h30m).  A plain number is in seconds.
+//
+// option->data must point to an int64_t, which gets the duration in
+// milliseconds.
+
+bool GetOpt::isDuration(GetOpt* getopt, const Option* option,
+                        const char* asEntered,
+                        Connection connected, const char* argument,
+                        int* usedChars)
+{
+  return convertNumber(getopt, option, asEntered, connected, argument,
+                       usedChars, parseDuration, sizeof(int64_t),
+                       " requires a duration (like 30s, 250ms or 1h30m)");
+} // end GetOpt::isDuration
+#endif // not GETOPT_NO_NUMBERS
+
+#ifndef GETOPT_NO_NUMBERS
+//====================================================================
+// Bulk conversion:
+//
+// A program that takes a long list of numbers as its normal arguments
+// can convert them all at once, instead of having the returningAll
+// option's callback called for each one:
+//
+//   const int  first = getopt.process(argc, argv);
+//   int64_t*   value = new int64_t[argc - first];
+//   if (getopt.convertArgs(first, value) < argc) ...
+//
+// The integers are read the way isLong reads them (that's strtol with
+// base 0: leading white space, then decimal, 0x for hex, or a leading
+// 0 for octal), and the doubles the way isFloat reads them (strtod,
+// with the locale's decimal point).  Every valid argument gets the
+// same value it would from them.  Unlike them, an empty argument is
+// not 0, and a number that doesn't fit (an integer outside int64_t,
+// or a double too big to be finite) is an error.
+//
+// Plain decimal numbers, which are most of them, don't go through
+// strtol or strtod.  Where the compiler targets SSE2 (every x86-64
+// does), the digits are converted 16 at a time (see readDigits).
+// Anything else is converted the slow way, so the results are
+// exactly the same.
+//--------------------------------------------------------------------
+// Read a run of decimal digits:
+//
+// Output:
+//   value:  The value of the digits (if there were no more than 16)
+//
+// Returns:
+//   The number of digits at p, or 17 if there are more than 16
+
+static int readDigitsScalar(const char* p, uint64_t& value)
+{
+  int  n = 0;
+
+  value = 0;
+  for (unsigned d; n < 17 && (d = digitValue(p[n], 10)) < 10; ++n)
+    value = value * 10 + d;
+
+  return n;
+} // end readDigitsScalar
+
+#ifdef GETOPT_SSE2
+// The SSE2 version loads the 16 bytes at p, which may go past the end
+// of the argument (but never onto another page, so it can't fault).
+// The digits are shifted to the top of the register, and then pairs
+// are combined by multiplying and adding (digits, then pairs, then
+// 4-digit groups) until two 8-digit halves are left.
+
+static int readDigits(const char* p, uint64_t& value)
+{
+  static const uintptr_t  pageSize = 4096;
+  static const char       keep[32] = { -1, -1, -1, -1, -1, -1, -1, -1,
+                                       -1, -1, -1, -1, -1, -1, -1, -1 };
+
+  if ((reinterpret_cast<uintptr_t>(p) & (pageSize - 1)) > pageSize - 16)
+    return readDigitsScalar(p, value);
+
+  __m128i  digits = _mm_sub_epi8(
+    _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)),
+    _mm_set1_epi8('0'));
+
+  // The bytes that aren't digits (as signed bytes, outside 0-9):
+  const unsigned  notDigit = _mm_movemask_epi8(
+    _mm_or_si128(_mm_cmpgt_epi8(digits, _mm_set1_epi8(9)),
+                 _mm_cmplt_epi8(digits, _mm_setzero_si128())));
+
+  if (!notDigit)
+    return readDigitsScalar(p, value); // 16 digits or more
+#ifdef __GNUC__
+  const int  n = __builtin_ctz(notDigit);
+#else
+  int  n = 0;
+  while (!(notDigit & (1u << n))) ++n;
+#endif
+
+  // Clear everything after the digits, and move them to the top:
+  digits = _mm_and_si128(digits, _mm_loadu_si128(
+    reinterpret_cast<const __m128i*>(keep + 16 - n)));
+
+  // (This is a 128-bit shift.  A count of 64 or more, including a
+  // negative one, shifts everything out of a 64-bit lane.)
+  const int      shift = 8 * (16 - n);
+  const __m128i  low = _mm_slli_si128(digits, 8);
+  digits = _mm_or_si128(
+    _mm_or_si128(_mm_sll_epi64(digits, _mm_cvtsi32_si128(shift)),
+                 _mm_srl_epi64(low, _mm_cvtsi32_si128(64 - shift))),
+    _mm_sll_epi64(low, _mm_cvtsi32_si128(shift - 64)));
+
+  // Combine them, most significant first:
+  const __m128i  zero = _mm_setzero_si128();
+  const __m128i  tens = _mm_set1_epi32(1 << 16 | 10);
+  const __m128i  pairs = _mm_packs_epi32(
+    _mm_madd_epi16(_mm_unpacklo_epi8(digits, zero), tens),
+    _mm_madd_epi16(_mm_unpackhi_epi8(digits, zero), tens));
+  const __m128i  quads = _mm_madd_epi16(pairs,
+                                        _mm_set1_epi32(1 << 16 | 100));
+  const __m128i  halves = _mm_madd_epi16(_mm_packs_epi32(quads, quads),
+                                         _mm_set1_epi32(1 << 16 | 10000));
+
+  const uint32_t  upper = _mm_cvtsi128_si32(halves);
+  const uint32_t  lower = _mm_cvtsi128_si32(_mm_srli_si128(halves, 4));
+  value = static_cast<uint64_t>(upper) * 100000000 + lower;
+
+  return n;
+} // end readDigits
+#else
+static inline int readDigits(const char* p, uint64_t& value)
+{
+  return readDigitsScalar(p, value);
+} // end readDigits
+#endif // not GETOPT_SSE2
+
+//--------------------------------------------------------------------
+// Parse an integer the way strtol does with base 0:
+//
+// This is parseInt64 with strtol's syntax: white space may come first,
+// and a number that starts with 0 is octal.
+
+static const char* parseCInteger(const char* p, Number& result,
+                                 bool& overflow)
+{
+  while (*p == ' ' || (*p >= '\t' && *p <= '\r'))
+    ++p;
+
+  const bool  negative = (*p == '-');
+  if (*p == '-' || *p == '+') ++p;
+
+  uint64_t  magnitude = 0;
+
+  if (*p == '0' && (p[1] | 0x20) != 'x') {
+    unsigned  d;
+    for (++p; (d = digitValue(*p, 8)) < 8; ++p) {
+      if (magnitude > (maxUInt64 >> 3))
+        overflow = true;
+      else
+        magnitude = magnitude * 8 + d;
+    }
+  } else {
+    const int  n = ((*p >= '1' && *p <= '9') ? readDigits(p, magnitude) : 0);
+    if (n && n <= 16)
+      p += n;
+    else if (!(p = parseUnsigned(p, magnitude, overflow)))
+      return NULL;
+  } // end else decimal or hex
+
+  if (magnitude > maxInt64 + negative)
+    overflow = true;
+  else if (negative)
+    result.i = (magnitude == maxInt64 + 1)
+      ? -static_cast<int64_t>(maxInt64) - 1
+      : -static_cast<int64_t>(magnitude);
+  else
+    result.i = static_cast<int64_t>(magnitude);
+
+  return p;
+} // end parseCInteger
+
+//--------------------------------------------------------------------
+// Convert the normal arguments to integers:
+//
+// Each error is reported (as invalidArgument, at the argument's
+// position) like an option's.  Without errorList, this stops at the
+// first one.
+//
+// Input:
+//   first:
+//     The index in argv of the first argument to convert (normally
+//     what process returned).  Every argument from there to the end
+//     is converted.
+//
+// Output:
+//   values:
+//     Room for argc - first numbers.  values[i] is the number in
+//     argument first + i, or 0 if it isn't a valid one.
+//
+// Returns:
+//   The index in argv of the first argument that wasn't a valid
+//   number, or argc if they all were
+
+int GetOpt::convertArgs(int first, int64_t* values)
+{
+  const int  savedArgi = argi;
+  int        failed = argc;
+
+  for (int i = first; i < argc; ++i) {
+    const char* const  arg = argAt(i);
+    Number             result = Number();
+    bool               overflow = false;
+    const char* const  end = (*arg ? parseCInteger(arg, result, overflow)
+                              : NULL);
+
+    if (end && !*end && !overflow) {
+      values[i - first] = result.i;
+      continue;
+    }
+
+    values[i - first] = 0;
+    if (failed == argc) failed = i;
+
+    argi = i;
+    report(invalidArgument, arg, ((end && !*end)
+                                  ? " is out of range"
+                                  : " is not an integer"));
+    if (!errorList) break;
+  } // end for each argument
+
+  argi = savedArgi;
+
+  return failed;
+} // end GetOpt::convertArgs
+
+#ifndef GETOPT_NO_STRTOD
+//--------------------------------------------------------------------
+// Parse a floating-point number the way strtod does:
+//
+// Plain decimal numbers that parseDouble would convert exactly are
+// converted here; anything else is passed to strtod.
+//
+// Input:
+//   p:         The number
+//   dotPoint:  True if the locale's decimal point is '.'
+//
+// Output:
+//   result:    The number
+//   overflow:  Set to true if the number was too big
+//
+// Returns:
+//   A pointer to the first character that wasn't used (which is p if
+//   there was no number)
+
+static const char* parseCDouble(const char* p, bool dotPoint,
+                                Number& result, bool& overflow)
+{
+  static const double  pow10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10,
+    1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21,
+    1e22
+  };
+
+  if (dotPoint) {
+    const char*  q = p;
+    if (*q == '-' || *q == '+') ++q;
+
+    // readDigits stops counting at 17, so more than 16 digits in a
+    // row isn't exact (and leaves q in the middle of them):
+    uint64_t   mantissa, fraction;
+    const int  whole = readDigits(q, mantissa);
+    int        digits = whole, exp10 = 0;
+    bool       exact = (whole <= 16);
+
+    q += whole;
+    if (*q == '.' && exact) {
+      const int  n = readDigits(++q, fraction);
+      q += n;
+      digits += n;
+      exp10 = -n;
+      exact = (n <= 16 && digits <= 19);
+      if (exact)
+        mantissa = mantissa * static_cast<uint64_t>(pow10[n]) + fraction;
+    } // end if decimal point
+
+    if ((*q | 0x20) == 'e' && digits) {
+      const char*  e = q + 1;
+      const bool   negExp = (*e == '-');
+      if (*e == '-' || *e == '+') ++e;
+
+      if (digitValue(*e, 10) < 10) {
+        int  exponent = 0;
+        for (unsigned d; exponent < 1000 && (d = digitValue(*e, 10)) < 10; ++e)
+          exponent = exponent * 10 + d;
+        exp10 += negExp ? -exponent : exponent;
+        q = e;
+      }
+    } // end if exponent
+
+    if (!*q && digits && exact &&
+        mantissa <= (static_cast<uint64_t>(1) << 53) &&
+        exp10 >= -22 && exp10 <= 22) {
+      // Both operands are exact, so one rounding gives the right answer:
+      result.d = static_cast<double>(mantissa);
+      if (exp10 < 0)
+        result.d /= pow10[-exp10];
+      else
+        result.d *= pow10[exp10];
+      if (*p == '-') result.d = -result.d;
+      return q;
+    }
+  } // end if the decimal point is '.'
+
+  char*  end;
+  errno = 0;
+  result.d = strtod(p, &end);
+  if (errno == ERANGE && (result.d == HUGE_VAL || result.d == -HUGE_VAL))
+    overflow = true;
+
+  return end;
+} // end parseCDouble
+
+//--------------------------------------------------------------------
+// Convert the normal arguments to doubles:
+//
+// This works just like the integer version.
+
+int GetOpt::convertArgs(int first, double* values)
+{
+  const char* const  point = localeconv()->decimal_point;
+  const bool         dotPoint = (point[0] == '.' && !point[1]);
+  const int          savedArgi = argi;
+  int                failed = argc;
+
+  for (int i = first; i < argc; ++i) {
+    const char* const  arg = argAt(i);
+    Number             result = Number();
+    bool               overflow = false;
+    const char* const  end = parseCDouble(arg, dotPoint, result, overflow);
+
+    if (end != arg && !*end && !overflow) {
+      values[i - first] = result.d;
+      continue;
+    }
+
+    values[i - first] = 0;
+    if (failed == argc) failed = i;
+
+    argi = i;
+    report(invalidArgument, arg, ((end != arg && !*end)
+                                  ? " is out of range"
+                                  : " is not a number"));
+    if (!errorList) break;
+  } // end for each argument
+
+  argi = savedArgi;
+
+  return failed;
+} // end GetOpt::convertArgs
+#endif // not GETOPT_NO_STRTOD
+#endif // not GETOPT_NO_NUMBERS
+
+//====================================================================
+// Typed options:
+//
+// An option built by GetOpt::bind (or bindEnum) has no callback.
+// Instead, its store member says what type of variable data points
+// to, and findNextOption stores the argument there itself by calling
+// storeArgument.  That saves an indirect call per option, and since
+// bind chooses store from the variable's type, the types can't be
+// mixed up:
+//
+//   static long         count;
+//   static double       ratio;
+//   static const char*  name;
+//   static bool         verbose;
+//   static const GetOpt::Option  options[] = {
+//     GetOpt::bind('c', "count",   count),
+//     GetOpt::bind('r', "ratio",   ratio),
+//     GetOpt::bind('n', "name",    name),
+//     GetOpt::bind('v', "verbose", verbose),
+//     { 0 }
+//   };
+//
+// The stores are:
+//   storeNone:        Call function (if any), as always
+//   storeBool:        Set a bool to true (takes no argument)
+//   storeInt, storeLong, storeULong:
+//                     Store an integer (decimal, or hex with 0x)
+//   storeDouble:      Store a floating-point number
+//   storeString:      Store a const char* (pointing to the argument)
+//   storeStringView:  Store a std::string_view (C++17 only)
+//   storeEnum:        Store the value in values whose name matches
+//                     the argument (the variable must be the size of
+//                     an int)
+//
+// Numbers are read exactly as isInt64 and isDouble read them (so
+// -n5v works as it does for them), and must fit in the variable.
+//--------------------------------------------------------------------
+// Store an option's argument according to its store member:
+//
+// Input:
+//   option, asEntered, connected, argument, usedChars:
+//     As for an argument callback function
+//
+// Returns:
+//   As for an argument callback function
+
+bool GetOpt::storeArgument(const Option* option, const char* asEntered,
+                           Connection connected, const char* argument,
+                           int* usedChars)
+{
+  if (!argument ||
+      ((connected == nextArg) && !(option->flag & GetOpt::needArg)))
+    return false; // No argument or non-connected optional argument
+
+  void* const  data = optionData(option);
+#ifndef GETOPT_NO_NUMBERS
+  Number       result;
+  bool         overflow = false;
+  const char*  end;
+#else
+  (void) usedChars;             // Only a number can use part of a bundle
+#endif
+
+  switch (option->store) {
+   case storeString:
+    *static_cast<const char**>(data) = argument;
+    return true;
+
+   case storeStringView:
+#if __cplusplus >= 201703L
+    *static_cast<std::string_view*>(data) =
+      std::string_view(argument, textLength(argument));
+    return true;
+#else
+    reportError(asEntered, " needs GetOpt.cpp compiled as C++17");
+    return false;
+#endif
+
+   case storeEnum:
+    for (const EnumValue* v = option->values; v && v->name; ++v) {
+      if (sameText(v->name, argument)) {
+        *static_cast<int*>(data) = v->value;
+        return true;
+      }
+    }
+    reportError(asEntered, " has an argument that is not a valid choice");
+    return false;
+
+#ifdef GETOPT_NO_STRTOD
+   case storeDouble:
+#ifdef GETOPT_NO_NUMBERS
+   case storeULong:
+   case storeInt:
+   case storeLong:
+#endif
+    reportError(asEntered, " needs GetOpt.cpp compiled with number support");
+    return false;
+#else
+   case storeDouble:
+    end = parseDouble(argument, result, overflow);
+    if (!checkNumber(this, asEntered, connected, argument, usedChars,
+                     end, overflow, " requires a numeric argument"))
+      return false;
+    *static_cast<double*>(data) = result.d;
+    return true;
+#endif // not GETOPT_NO_STRTOD
+
+#ifndef GETOPT_NO_NUMBERS
+   case storeULong:
+    end = parseUInt64(argument, result, overflow);
+    if (end && result.u > ULONG_MAX) overflow = true;
+    if (!checkNumber(this, asEntered, connected, argument, usedChars, end,
+                     overflow, " requires a non-negative integer argument"))
+      return false;
+    *static_cast<unsigned long*>(data) =
+      static_cast<unsigned long>(result.u);
+    return true;
+
+   case storeInt:
+   case storeLong:
+    end = parseInt64(argument, result, overflow);
+    if (end && (option->store == storeInt
+                ? (result.i < INT_MIN || result.i > INT_MAX)
+                : (result.i < LONG_MIN || result.i > LONG_MAX)))
+      overflow = true;
+    if (!checkNumber(this, asEntered, connected, argument, usedChars,
+                     end, overflow, " requires an integer argument"))
+      return false;
+    if (option->store == storeInt)
+      *static_cast<int*>(data) = static_cast<int>(result.i);
+    else
+      *static_cast<long*>(data) = static_cast<long>(result.i);
+    return true;
+#endif // not GETOPT_NO_NUMBERS
+
+   case storeNone:              // Only a captured argument (no function)
+    return true;
+
+   default:                     // storeBool takes nothing
+    return false;
+  } // end switch on store
+} // end GetOpt::storeArgument
+
+//--------------------------------------------------------------------
+// Determine whether an option can take an argument:
+//
+// Only a function, a typed store (see bind), or the capture flag
+// with needArg can do anything with one.
+
+static bool takesArgument(const GetOpt::Option* option)
+{
+  return (option->function || option->store > GetOpt::storeBool ||
+          ((option->flag & (GetOpt::capture | GetOpt::needArg)) ==
+           (GetOpt::capture | GetOpt::needArg)));
+} // end takesArgument
+
+//====================================================================
+// Capturing occurrences:
+//
+// An option with the capture flag has every occurrence recorded, so
+// a repeatable option like -I dir doesn't need a callback to collect
+// its arguments.  The occurrences go into one array that belongs to
+// the GetOpt and is reused for each command line, so once it is big
+// enough, capturing allocates nothing.  A captured option with
+// needArg takes its argument even if it has no function:
+//
+//   static const GetOpt::Option  options[] = {
+//     { 'I', "include", NULL,
+//       GetOpt::needArg | GetOpt::repeatable | GetOpt::capture },
+//     ...
+//   };
+//
+//   GetOpt::Occurrences  dirs = getopt.occurrences(options);
+//   for (const GetOpt::Occurrence* o = dirs.begin(); o != dirs.end(); ++o)
+//     addIncludeDir(o->argument);
+//
+// The arguments point into argv (or a response file), and like
+// everything else here are good until the next init or process.
+//
+// Occurrence Member Variables:
+//   option:     The option
+//   argument:   Its argument (as passed to its callback), or NULL if
+//               it didn't take one
+//   connected:  How the argument was connected to the option
+//   position:   The index in argv of the argument that contained the
+//               option (the one that introduced the response file,
+//               if the option came from one).  This is its index
+//               after the options have been moved ahead of the
+//               non-option arguments, like currentArg.
+//--------------------------------------------------------------------
+// Record an occurrence:
+
+void GetOpt::addOccurrence(const Option* option, const char* argument,
+                           Connection connected, int position)
+{
+  if (occurrenceCount == occurrenceSize) {
+    const int    newSize = occurrenceSize ? 2 * occurrenceSize : 64;
+    Occurrence*  newOccurrence = new Occurrence[newSize];
+    if (occurrenceCount)
+      memcpy(newOccurrence, occurrence,
+             occurrenceCount * sizeof(*occurrence));
+    delete [] occurrence;
+    occurrence     = newOccurrence;
+    occurrenceSize = newSize;
+  } // end if occurrence is full
+
+  Occurrence&  o = occurrence[occurrenceCount++];
+  o.option    = option;
+  o.argument  = argument;
+  o.connected = connected;
+  o.position  = position;
+} // end GetOpt::addOccurrence
+
+//--------------------------------------------------------------------
+// Return all the occurrences found so far, in order:
+
+GetOpt::Occurrences GetOpt::occurrences() const
+{
+  Occurrences  all;
+
+  all.first = occurrence;
+  all.last  = occurrence + occurrenceCount;
+
+  return all;
+} // end GetOpt::occurrences
+
+//--------------------------------------------------------------------
+// Return the occurrences of one option, in order:
+//
+// The first call after the command line has changed sorts all the
+// occurrences by option (which takes time proportional to their
+// number plus the number of options).  After that, each call takes
+// constant time.
+//
+// Input:
+//   option:  The option (which must be in optionList)
+
+GetOpt::Occurrences GetOpt::occurrences(const Option* option)
+{
+  if (groupedCount != occurrenceCount) {
+    if (!groupEnd) groupEnd = new int[optionCount];
+    if (!grouped || groupedSize < occurrenceSize) {
+      delete [] grouped;
+      grouped = new Occurrence[occurrenceSize];
+      groupedSize = occurrenceSize;
+    }
+
+    // Counting sort (stable, so each option's stay in order):
+    memset(groupEnd, 0, optionCount * sizeof(*groupEnd));
+    for (int i = 0; i < occurrenceCount; ++i)
+      if (isGlobal(occurrence[i].option))
+        ++groupEnd[occurrence[i].option - optionList];
+
+    int  start = 0;
+    for (int i = 0; i < optionCount; ++i) {
+      const int  count = groupEnd[i];
+      groupEnd[i] = start;      // For now, where the next one goes
+      start += count;
+    }
+
+    for (int i = 0; i < occurrenceCount; ++i)
+      if (isGlobal(occurrence[i].option))
+        grouped[groupEnd[occurrence[i].option - optionList]++] =
+          occurrence[i];
+
+    groupedCount = occurrenceCount;
+  } // end if not sorted yet
+
+  const int    i = option - optionList;
+  Occurrences  some;
+
+  some.first = grouped + (i ? groupEnd[i - 1] : 0);
+  some.last  = grouped + groupEnd[i];
+
+  return some;
+} // end GetOpt::occurrences
+
+//====================================================================
+// Lazy queries:
+//
+// A program that only wants to know whether one or two options were
+// given (perhaps before handing the command line to something else)
+// doesn't need to process all of it.  Instead of process, it can
+// call scan, which just notes which arguments look like options, and
+// then ask about the options it cares about:
+//
+//   getopt.scan(argc, argv);
+//   if (getopt.has(&options[VERBOSE])) ...
+//   const char*  output = getopt.value(&options[OUTPUT]);
+//
+// Only the options asked about are looked up and passed their
+// arguments, so the cost depends mostly on the questions rather than
+// on argc.  (Deciding whether an argument belongs to the option
+// before it may require looking that option up, too.)
+//
+// Asking about an option does everything process would have done for
+// each occurrence of it: its function or store gets its argument,
+// its found flag is set, and it is captured.  This happens once, the
+// first time it is asked about.  argv is never changed.
+//
+// The differences from process are:
+//   Only needArg options take an argument that isn't connected to
+//   them (like -o file).  Other options get an argument only after
+//   '=' (-o=file or --output=file).
+//   An option that takes an argument in a bundle of short options
+//   gets the rest of the bundle (usedChars is NULL).
+//   Response files and ArgSources are not read.  An argument that
+//   starts with responseFileStart is a normal argument.
+//   Options that aren't asked about are never checked, so an
+//   unrecognized option is not an error.
+//
+// Scanned Member Variables:
+//   type:    What classify said the argument is
+//   equals:  For a long option, the offset of its '=' (0 if none)
+//   value:   1 if the argument belongs to the option before it, 0 if
+//            not, -1 if not known yet
+//   next:    1 if the argument is an option that takes the next
+//            argument, 0 if not, -1 if not known yet
+//
+// Query Member Variables:
+//   done:    True if the option has been looked for
+//   found:   noArg or withArg if it was found (as for its found
+//            flag), notFound if not.  Looking for it stops at the
+//            first error.
+//   value:   The argument of its last occurrence, or NULL
+//--------------------------------------------------------------------
+
+struct GetOpt::Scanned
+{
+  Type         type;
+  int          equals;
+  signed char  value;
+  signed char  next;
+}; // end GetOpt::Scanned
+
+struct GetOpt::Query
+{
+  bool         done;
+  Found        found;
+  const char*  value;
+}; // end GetOpt::Query
+
+//--------------------------------------------------------------------
+// Prepare to answer questions about a command line:
+//
+// This resets all the found flags (like init) and classifies each
+// argument, but doesn't process any options.
+//
+// Input:
+//   theArgc, theArgv:
+//     As for init, except that theArgv is never written to
+
+void GetOpt::scan(int theArgc, const char* const* theArgv)
+{
+  // argv is only read by lazy queries:
+  start(theArgc, const_cast<const char**>(theArgv), NULL);
+  clearFound();
+
+  if (scannedSize < argc) {
+    const int  newSize = (2 * scannedSize > argc) ? 2 * scannedSize : argc;
+    delete [] scanned;
+    delete [] positional;
+    scanned     = new Scanned[newSize];
+    positional  = new const char*[newSize];
+    scannedSize = positionalSize = newSize;
+  } // end if need more room
+
+  if (!query) query = new Query[optionCount];
+  for (int i = 0; i < optionCount; ++i)
+    query[i].done = false;
+
+  scanEnd = -1;
+  scanning = true;
+  positionalCount = -1;
+
+  for (int i = 1; i < argc; ++i) {
+    const char*  name;
+    Scanned&     s = scanned[i];
+
+    s.type   = classify(argv[i], name);
+    s.equals = 0;
+    s.value  = s.next = -1;
+    if (s.type == optLong) {
+      const char* const  equals = findChar(name, '=');
+      if (equals) s.equals = int(equals - argv[i]);
+    }
+  } // end for each argument
+} // end GetOpt::scan
+
+//--------------------------------------------------------------------
+// Determine whether an option was given:
+//
+// Input:
+//   option:  The option (which must be in optionList)
+//
+// Returns:
+//   true if the option was found (check error to see whether it had
+//   a problem)
+
+bool GetOpt::has(const Option* option)
+{
+  const Query&  q = resolve(option);
+
+  return (q.found != notFound);
+} // end GetOpt::has
+
+//--------------------------------------------------------------------
+// Return the argument of an option:
+//
+// Input:
+//   option:  The option (which must be in optionList)
+//
+// Returns:
+//   The argument used by the option's last occurrence, or NULL if it
+//   wasn't found or didn't use an argument
+
+const char* GetOpt::value(const Option* option)
+{
+  return resolve(option).value;
+} // end GetOpt::value
+
+//--------------------------------------------------------------------
+// Find the normal (non-option) arguments:
+//
+// After scan, this has to decide which arguments belong to options,
+// so it looks up each option that is followed by a normal argument.
+//
+// After process (or once nextOption returns false), these are the
+// arguments from currentArg() on, with the normal arguments read
+// from response files put back where they were on the command line.
+// (Those can't be moved into argv, so this is the only place to find
+// them.)
+//
+// Output:
+//   list:  The normal arguments, in order.  This is good until the
+//          next scan or init.
+//
+// Returns:
+//   The number of normal arguments
+
+int GetOpt::positionals(const char* const*& list)
+{
+  if (!scanning) {
+    const int  first = (argi < argc) ? argi : argc;
+    const int  count = argc - first + sourceArgCount;
+
+    if (positionalSize < count) {
+      const char**  newList = new const char*[count];
+      delete [] positional;
+      positional     = newList;
+      positionalSize = count;
+    }
+
+    // Merge them, each source argument going after sourceArgBefore
+    // of the ones in argv:
+    int  i = first, k = 0;
+    for (positionalCount = 0; positionalCount < count; ++positionalCount)
+      positional[positionalCount] =
+        ((k < sourceArgCount && sourceArgBefore[k] <= i - first)
+         ? sourceArg[k++] : argAt(i++));
+  } else if (positionalCount < 0) {
+    const int  end = optionsEnd();
+
+    positionalCount = 0;
+    for (int i = 1; i < argc; ++i)
+      if ((i > end) ||
+          ((i < end) && (scanned[i].type == optArg) && !isValue(i)))
+        positional[positionalCount++] = argv[i];
+  } // end if not found yet
+
+  list = positional;
+  return positionalCount;
+} // end GetOpt::positionals
+
+//--------------------------------------------------------------------
+// Look for all occurrences of an option:
+//
+// Input:
+//   option:  The option (which must be in optionList)
+//
+// Returns:
+//   Its entry in query
+
+const GetOpt::Query& GetOpt::resolve(const Option* option)
+{
+  Query&  q = query[option - optionList];
+
+  if (q.done) return q;
+
+  q.done  = true;
+  q.found = notFound;
+  q.value = NULL;
+
+  const int   end = optionsEnd();
+  const char  shortName = option->shortName;
+  const char  longStart = option->longName ? option->longName[0] : 0;
+  Found       found = noArg;
+
+  for (int i = 1; i < end && found != notFound; ++i) {
+    const Scanned&  s = scanned[i];
+    const char*     arg = argv[i];
+    const char*     value;
+    Connection      connect;
+
+    if (s.type == optLong) {
+      // Every match begins with the same character, or with a '-'
+      // that stands for the first segment (see matchName), so check
+      // that before looking the option up:
+      if (!longStart || (arg[2] != longStart && arg[2] != '-')) continue;
+      curArg = arg;
+      if (findLongOption(arg + 2) != option || isValue(i)) continue;
+
+      value = lazyArgument(option, i, s.equals ? arg + s.equals : "",
+                           connect);
+      argi  = i;                // So an error is recorded where it is
+      chari = 0;
+      found = useOption(option, arg, connect, value, NULL, i);
+      q.found = (found != notFound) ? found : noArg; // Even if bad
+      q.value = (found == withArg) ? value : NULL;
+    } else if (s.type == optShort) {
+      if (!shortName || !findChar(arg + 1, shortName) || isValue(i))
+        continue;
+
+      for (int c = 1; arg[c] && found != notFound; ++c) {
+        const Option* const  o = findShortOption(arg[c]);
+        if (!o) break;          // process would stop here
+
+        value = lazyArgument(o, i, arg + c + 1, connect);
+        if (o == option) {
+          shortOptionBuf[0] = arg[0];
+          shortOptionBuf[1] = arg[c];
+          shortOptionBuf[2] = 0;
+          curArg = arg;
+          argi   = i;
+          chari  = c;
+          found = useOption(option, shortOptionBuf, connect, value, NULL, i);
+          q.found = (found != notFound) ? found : noArg;
+          q.value = (found == withArg) ? value : NULL;
+        }
+        if (value && connect != nextArg) break; // Used rest of bundle
+      } // end for each option in bundle
+    } // end else if short option bundle
+  } // end for each argument until an error or the end of the options
+
+  return q;
+} // end GetOpt::resolve
+
+//--------------------------------------------------------------------
+// Find the "--" that ends the options:
+//
+// Returns:
+//   Its index, or argc if there isn't one
+
+int GetOpt::optionsEnd()
+{
+  if (scanEnd < 0) {
+    scanEnd = argc;
+    for (int i = 1; i < argc; ++i)
+      if ((scanned[i].type == optLong) && !argv[i][2] && !isValue(i)) {
+        scanEnd = i;
+        break;
+      }
+  } // end if not found yet
+
+  return scanEnd;
+} // end GetOpt::optionsEnd
+
+//--------------------------------------------------------------------
+// Determine whether an argument belongs to the option before it:
+//
+// This is true if the argument before it is an option that takes the
+// next argument, and doesn't itself belong to an option.  So in a run
+// of such options, every other one is an argument.  This walks back
+// to the start of the run and then fills in the answers going
+// forward.
+//
+// Input:
+//   i:  The index of the argument, which must be before the "--" (if
+//       any) that ends the options
+
+bool GetOpt::isValue(int i)
+{
+  if (scanned[i].value < 0) {
+    int  first = i;
+
+    while (first > 1 && scanned[first - 1].value < 0 && takesNext(first - 1))
+      --first;
+
+    // Either first is 1, or we know the answer for first - 1, or it
+    // doesn't take the next argument:
+    bool  value = ((first > 1) && (scanned[first - 1].value == 0) &&
+                   takesNext(first - 1));
+
+    for (; first <= i; ++first) {
+      scanned[first].value = value;
+      value = !value;           // Everything before i takes the next one
+    }
+  } // end if not known yet
+
+  return scanned[i].value != 0;
+} // end GetOpt::isValue
+
+//--------------------------------------------------------------------
+// Determine whether an argument is an option that takes the next one:
+//
+// This remembers the answer (see optionTakingNext).
+//
+// Input:
+//   i:  The index of the argument, which must be before the "--" (if
+//       any) that ends the options
+
+bool GetOpt::takesNext(int i)
+{
+  Scanned&  s = scanned[i];
+
+  if (s.next < 0)
+    s.next = (optionTakingNext(i) != NULL);
+
+  return s.next != 0;
+} // end GetOpt::takesNext
+
+//--------------------------------------------------------------------
+// Find the option in an argument that takes the next argument:
+//
+// This doesn't check whether the argument belongs to the option
+// before it (see isValue).
+//
+// Input:
+//   i:  The index of the argument, which must be before the "--" (if
+//       any) that ends the options
+//
+// Returns:
+//   The option, or NULL if the argument isn't an option that takes
+//   the next one
+
+const GetOpt::Option* GetOpt::optionTakingNext(int i)
+{
+  const Scanned&     s = scanned[i];
+  const char* const  arg = argv[i];
+  const Option*      option;
+  Connection         connect;
+
+  if ((i + 1 >= argc) || (s.type == optArg))
+    return NULL;                // A normal argument, or nothing to take
+
+  if (s.type == optLong) {
+    curArg = arg;
+    if (!s.equals && arg[2] && (option = findLongOption(arg + 2)) &&
+        lazyArgument(option, i, "", connect))
+      return option;
+    return NULL;
+  } // end if long option
+
+  for (int c = 1; arg[c]; ++c) {
+    if (!(option = findShortOption(arg[c]))) break;
+    if (lazyArgument(option, i, arg + c + 1, connect))
+      return (connect == nextArg) ? option : NULL;
+  } // end for each option in bundle
+
+  return NULL;
+} // end GetOpt::optionTakingNext
+
+//--------------------------------------------------------------------
+// Find the argument an option gets in a lazy query:
+//
+// Input:
+//   option:  The option
+//   i:       The index of the argument it is in
+//   after:   Points just past the option's name in argv[i]
+//
+// Output:
+//   connected:  How the argument is connected to the option
+//
+// Returns:
+//   The argument, or NULL if it doesn't get one
+
+const char* GetOpt::lazyArgument(const Option* option, int i,
+                                 const char* after,
+                                 Connection& connected) const
+{
+  connected = nextArg;
+  if (!takesArgument(option)) return NULL;
+
+  if (*after == '=') {
+    connected = withEquals;
+    return after + 1;
+  }
+
+  if (!(option->flag & GetOpt::needArg)) return NULL;
+
+  if (*after) {
+    connected = adjacent;
+    return after;
+  }
+
+  return (i + 1 < argc) ? argv[i + 1] : NULL;
+} // end GetOpt::lazyArgument
+
+//====================================================================
+// Class GetOpt::LongIndex:
+//
+// Looks up long options in the prefix tree built by GetOpt::fillIndex.
+//
+// Member Variables:
+//   node:
+//     The nodes of the tree.  node[0] is the root (the empty string).
+//   scanned, compared, searched:
+//     With GETOPT_STATS, the nodes looked at, the characters compared,
+//     and the searches for an abbreviation, to be added to
+//     GetOpt::stats
+//
+// Match Member Variables:
+//   count:   The number of options that might match
+//   option:  One of them (the first found)
+//   found:   If not NULL, every option that might match is stored
+//            here (instead of stopping when a second one is seen)
+//--------------------------------------------------------------------
+
+struct GetOpt::LongIndex
+{
+  struct Match
+  {
+    int   count;
+    int   option;
+    int*  found;
+  }; // end GetOpt::LongIndex::Match
+
+  const IndexNode*  node;
+#ifdef GETOPT_STATS
+  mutable long      scanned, compared, searched;
+
+  explicit LongIndex(const IndexNode* aNode)
+  : node(aNode), scanned(0), compared(0), searched(0) {}
+#else
+
+  explicit LongIndex(const IndexNode* aNode) : node(aNode) {}
+#endif
+
+  int   child(int parent, char ch) const;
+  int   find(const char* option, bool& ambiguous) const;
+  void  match(int n, const char* u, Match& m) const;
+  void  skipSegment(int n, const char* u, Match& m) const;
+  void  collect(int n, Match& m) const;
+}; // end GetOpt::LongIndex
+
+//====================================================================
+// Class GetOpt::Storage:
+//
+// The lookup tables built by GetOpt::compile and GetOpt::buildIndex.
+// A GetOpt constructed from precomputed Tables doesn't have one.
+//--------------------------------------------------------------------
+
+struct GetOpt::Storage
+{
+  const Option*  shortOption[256];
+  const char**   longName;
+  Found**        foundList;
+  IndexNode*     node;
+
+  Storage() : longName(NULL), foundList(NULL), node(NULL) {}
+  ~Storage()
+  {
+    delete [] node;
+    delete [] foundList;
+    delete [] longName;
+  }
+}; // end GetOpt::Storage
+
+//--------------------------------------------------------------------
+// Find the child of a node that is reached by a character:
+//
+// Returns:
+//   The index of the child node, or -1 if there is none
+
+int GetOpt::LongIndex::child(int parent, char ch) const
+{
+  int  c = node[parent].firstChild;
+
+  while (c >= 0 && node[c].ch != ch) {
+    GETOPT_COUNT(++scanned);
+    GETOPT_COUNT(++compared);
+    c = node[c].nextSibling;
+  }
+#ifdef GETOPT_STATS
+  if (c >= 0) { ++scanned; ++compared; }
+#endif
+
+  return c;
+} // end GetOpt::LongIndex::child
+
+//--------------------------------------------------------------------
+// Look up a long option:
+//
+// This follows exactly the same rules as the scan in findLongOption.
+// An exact match is found by walking the tree once.  Otherwise, each
+// '-' the user typed may abbreviate the rest of a name segment, so
+// the search may branch there, but it stops as soon as a second
+// possible match is seen.
+//
+// Input:
+//   option:  As for findLongOption
+//
+// Output:
+//   ambiguous:  Set to true if more than one option might match
+//
+// Returns:
+//   The index in optionList of the matching option, or -1
+
+int GetOpt::LongIndex::find(const char* option, bool& ambiguous) const
+{
+  ambiguous = false;
+
+  int  n = 0;
+  const char* u = option;
+
+  while (n >= 0 && *u && *u != '=')
+    n = child(n, *u++);
+
+  if (n >= 0 && node[n].exact >= 0)
+    return node[n].exact;       // Exact match!
+
+  Match  m;
+  m.count  = 0;
+  m.option = -1;
+  m.found  = NULL;
+
+  GETOPT_COUNT(++searched);
+  match(0, option, m);
+
+  if (m.count > 1) {
+    ambiguous = true;
+    return -1;
+  }
+
+  return m.option;
+} // end GetOpt::LongIndex::find
+
+//--------------------------------------------------------------------
+// Collect the possible matches below a node:
+//
+// Input:
+//   n:  The node that matched everything the user typed before u
+//   u:  The rest of the user's entry
+//
+// Output:
+//   m:  Updated with the options that might match
+
+void GetOpt::LongIndex::match(int n, const char* u, Match& m) const
+{
+  if (!*u || *u == '=') {       // Reached end of user entry
+    if (m.found)
+      collect(n, m);
+    else {
+      if (!m.count) m.option = node[n].first;
+      m.count += node[n].count;
+    }
+    return;
+  }
+
+  for (int c = node[n].firstChild; c >= 0 && (m.count < 2 || m.found);
+       c = node[c].nextSibling) {
+    GETOPT_COUNT(++scanned);
+    GETOPT_COUNT(++compared);
+    if (node[c].ch == *u)
+      match(c, u+1, m);
+    else if (*u == '-')
+      skipSegment(c, u+1, m);   // '-' abbreviates the rest of a segment
+  }
+} // end GetOpt::LongIndex::match
+
+//--------------------------------------------------------------------
+// Skip to the end of a name segment:
+//
+// Names that end before the next '-' do not match.
+//
+// Input:
+//   n:  A node in the middle of a name segment
+//   u:  The rest of the user's entry (after the '-')
+//
+// Output:
+//   m:  Updated with the options that might match
+
+void GetOpt::LongIndex::skipSegment(int n, const char* u, Match& m) const
+{
+  for (int c = node[n].firstChild; c >= 0 && (m.count < 2 || m.found);
+       c = node[c].nextSibling) {
+    GETOPT_COUNT(++scanned);
+    GETOPT_COUNT(++compared);
+    if (node[c].ch == '-')
+      match(c, u, m);
+    else
+      skipSegment(c, u, m);
+  }
+} // end GetOpt::LongIndex::skipSegment
+
+//--------------------------------------------------------------------
+// Store every option whose name ends below a node:
+//
+// Input:
+//   n:  The node
+//
+// Output:
+//   m:  The options are added to m.found
+
+void GetOpt::LongIndex::collect(int n, Match& m) const
+{
+  if (node[n].exact >= 0)
+    m.found[m.count++] = node[n].exact;
+
+  for (int c = node[n].firstChild; c >= 0; c = node[c].nextSibling)
+    collect(c, m);
+} // end GetOpt::LongIndex::collect
+
+//====================================================================
+// Class GetOpt::Suggester:
+//
+// Finds the long options that are closest to something the user
+// typed, so an unrecognized option can be reported along with what
+// the user probably meant.  Closeness is edit distance: the number
+// of characters that must be inserted, deleted or changed to turn
+// one string into the other.
+//
+// Rather than computing the distance to every name, this walks the
+// prefix tree used by findLongOption (see fillIndex).  Going down
+// one node computes one more row of the usual edit distance table,
+// so names with a common prefix share the work for it, and a subtree
+// is abandoned as soon as every entry in its row is over the limit
+// (since nothing below it can be any closer).
+//
+// It's created the first time it's needed, so it costs nothing until
+// the user makes a mistake.
+//
+// Member Variables:
+//   node:
+//     The prefix tree (see prefixTree)
+//   maxLength:
+//     The length of the longest long option name
+//   row, rowSize:
+//     One row of the edit distance table for each level of the tree
+//     (see search), with room for rowSize entries in all
+//   next:
+//     For each level of the tree, the next node search will look at
+//     there (maxLength + 1 entries, or NULL until the first search).
+//     Keeping these here instead of recursing keeps the stack a
+//     search needs from depending on the length of the names.
+//   best, bestSize:
+//     The distances of the suggestions found by the current search,
+//     with room for bestSize of them
+//   suggested, suggestedSize:
+//     The suggestions for GetOpt::unrecognized, with room for
+//     suggestedSize of them
+//   message, messageSize:
+//     The error message built by GetOpt::unrecognized, with room for
+//     messageSize characters
+//
+// Search Member Variables:
+//   text, length:  What the user typed
+//   limit:         The largest distance worth suggesting.  Once max
+//                  suggestions have been found, this shrinks to the
+//                  distance of the farthest one.
+//   list:          The suggestions found so far, closest first
+//   count, max:    The number found, and the most wanted
+//--------------------------------------------------------------------
+
+struct GetOpt::Suggester
+{
+  struct Search
+  {
+    const char*     text;
+    int             length;
+    int             limit;
+    const Option**  list;
+    int             count, max;
+  }; // end GetOpt::Suggester::Search
+
+  const IndexNode*  node;
+  int               maxLength;
+  int*              row;
+  int               rowSize;
+  int*              next;
+  int*              best;
+  int               bestSize;
+  const Option**    suggested;
+  int               suggestedSize;
+  char*             message;
+  int               messageSize;
+
+  Suggester()
+  : node(NULL), maxLength(0), row(NULL), rowSize(0), next(NULL),
+    best(NULL), bestSize(0), suggested(NULL), suggestedSize(0),
+    message(NULL), messageSize(0)
+  {}
+  ~Suggester()
+  {
+    delete [] message;
+    delete [] suggested;
+    delete [] best;
+    delete [] next;
+    delete [] row;
+  }
+
+  void  search(Search& s, const Option* optionList);
+}; // end GetOpt::Suggester
+
+//--------------------------------------------------------------------
+// Search the tree for the names closest to some text:
+//
+// The walk goes depth first, one level of next per node on the path
+// down.  The row for the root must already be filled in: row[j] is
+// j, the distance between the empty name and the first j characters
+// of s.text.  After that, row[depth * (s.length + 1) + j] is the
+// distance for the name so far at that depth, as long as that is at
+// most s.limit (cells farther out are only known to be more).
+//
+// Input:
+//   s:           The search
+//   optionList:  The options (for filling in s.list)
+
+void GetOpt::Suggester::search(Search& s, const Option* optionList)
+{
+  const int  width = s.length + 1;
+  int        depth = 0;
+
+  next[0] = node[0].firstChild;
+  while (depth >= 0) {
+    const int  c = next[depth];
+    if (c < 0) {                // Back up to the parent's next child
+      --depth;
+      continue;
+    }
+    next[depth] = node[c].nextSibling;
+
+    const char  ch    = node[c].ch;
+    const int*  above = row + depth * width;
+    int*        here  = row + (depth + 1) * width;
+    const int   level = depth + 1;
+    if (level - s.length > s.limit)
+      continue;                 // Every name here is too much longer
+
+    const int   first = (level > s.limit ? level - s.limit : 1);
+    const int   last  = (level + s.limit < s.length ? level + s.limit
+                                                    : s.length);
+    int         rowMin = level;
+
+    // Only the band within s.limit of the diagonal can be close enough.
+    // The cells just outside it get s.limit + 1 (no more than their
+    // true distance), which is all the next row needs from them:
+    here[first - 1] = (first > 1 ? s.limit + 1 : level);
+    if (last < s.length) here[last + 1] = s.limit + 1;
+    for (int j = first; j <= last; ++j) {
+      int  d = above[j-1] + (s.text[j-1] != ch);
+      if (above[j] + 1 < d) d = above[j] + 1;
+      if (here[j-1] + 1 < d) d = here[j-1] + 1;
+      here[j] = d;
+      if (d < rowMin) rowMin = d;
+    } // end for each character of text in the band
+
+    const int  d = (last == s.length ? here[s.length] : s.limit + 1);
+    if (node[c].exact >= 0 && d <= s.limit) {
+      const Option* const  option = optionList + node[c].exact;
+      const bool           full = (s.count == s.max);
+
+      if (!full || d < best[s.max - 1] ||
+          (d == best[s.max - 1] && option < s.list[s.max - 1])) {
+        // Insert it in order of distance (then position in optionList):
+        int  i = full ? s.max - 1 : s.count++;
+        while (i > 0 && (best[i-1] > d ||
+                         (best[i-1] == d && s.list[i-1] > option))) {
+          best[i]   = best[i-1];
+          s.list[i] = s.list[i-1];
+          --i;
+        }
+        best[i]   = d;
+        s.list[i] = option;
+        if (s.count == s.max) s.limit = best[s.max - 1];
+      } // end if it's one of the closest so far
+    } // end if a name ends here
+
+    if (rowMin <= s.limit)      // Something below might be close enough
+      next[++depth] = node[c].firstChild;
+  } // end while nodes are left
+} // end GetOpt::Suggester::search
+
+//====================================================================
+// Completion:
+//
+// A shell can ask a program which long options the word under the
+// cursor could be.  complete uses the same prefix tree and the same
+// rules as findLongOption (including a '-' standing for the rest of
+// a name segment), so process accepts every completion it offers.
+// It looks at the words before the cursor the way lazy queries do
+// (see scan), so it knows when the word is really the argument of
+// the option before it.
+//
+// printCompletions answers a request made by running the program as
+//
+//   prog --complete WORD...
+//
+// where the last WORD is the one under the cursor (and may be "").
+// It prints the completions one per line, and its return value is
+// meant to be the program's exit status.  In bash:
+//
+//   _prog() {
+//     COMPREPLY=($(prog --complete "${COMP_WORDS[@]:1:COMP_CWORD}"))
+//     [ $? = 2 ] && COMPREPLY=($(compgen -f -- "${COMP_WORDS[COMP_CWORD]}"))
+//   }
+//   complete -F _prog prog
+//--------------------------------------------------------------------
+// Sort option indexes:
+//
+// A freestanding build has no qsort, so it uses a heapsort.
+
+#ifdef GETOPT_FREESTANDING
+static void sortIndexes(int* index, int count)
+{
+  for (int end = count, i = count / 2; end > 1; ) {
+    int  value;
+    if (i > 0)
+      value = index[--i];       // Still building the heap
+    else {
+      value = index[--end];     // Move the largest to the end
+      index[end] = index[0];
+    }
+
+    int  hole = i;              // Sift value down from there
+    for (int child; (child = 2 * hole + 1) < end; hole = child) {
+      if (child + 1 < end && index[child + 1] > index[child]) ++child;
+      if (index[child] <= value) break;
+      index[hole] = index[child];
+    }
+    index[hole] = value;
+  } // end for each step
+} // end sortIndexes
+#else
+static int compareIndexes(const void* a, const void* b)
+{
+  return *static_cast<const int*>(a) - *static_cast<const int*>(b);
+} // end compareIndexes
+
+static void sortIndexes(int* index, int count)
+{
+  qsort(index, count, sizeof(*index), compareIndexes);
+} // end sortIndexes
+#endif // not GETOPT_FREESTANDING
+
+//--------------------------------------------------------------------
+// Find the long options that a word could be completed to:
+//
+// Like scan, this resets the found flags, and it doesn't process
+// any options.  It reports no errors.
+//
+// Input:
+//   theArgc, theArgv:
+//     The words typed so far, as for scan.  The last one is the word
+//     being completed (with theArgv[0] the program name).
+//
+// Output:
+//   list:
+//     The options that the last word could be, in the order of
+//     optionList (good until the next call)
+//   argumentOf:
+//     If the last word is the argument of an option (either because
+//     the option before it takes the next argument, or because it's
+//     --name=something), that option.  Otherwise NULL.
+//
+// Returns:
+//   The number of options in list (0 if argumentOf is not NULL, or
+//   if the word isn't a long option)
+
+int GetOpt::complete(int theArgc, const char* const* theArgv,
+                     const Option* const*& list, const Option*& argumentOf)
+{
+  ErrorFunc* const    output = errorOutput;
+  ErrorRecord* const  records = errorList;
+  int                 count = 0;
+
+  errorOutput = NULL;           // Stay quiet about ambiguous options
+  errorList   = NULL;
+  argumentOf  = NULL;
+  list        = completion;
+
+  scan(theArgc, theArgv);
+
+  const int  i = argc - 1;      // The word being completed
+
+  if (i < 1 || optionsEnd() < i) {
+    // Nothing to complete, or it comes after "--"
+  } else if (isValue(i)) {
+    argumentOf = optionTakingNext(i - 1);
+  } else {
+    const char* const  word = argv[i];
+    const char*        prefix = NULL;
+
+    if (word[0] == '-' && !word[1])
+      prefix = "";              // Complete "-" as "--"
+    else if (startsWith(word, longOptionStart))
+      prefix = word + sizeof(longOptionStart) - 1;
+
+    if (prefix && findChar(prefix, '=')) {
+      curArg = word;
+      const Option* const  option = findLongOption(prefix);
+      if (option && takesArgument(option))
+        argumentOf = option;
+    } else if (prefix) {
+      if (!completion) {
+        completed  = new int[optionCount + 1];
+        completion = new const Option*[optionCount + 1];
+        list       = completion;
+      }
+
+      LongIndex::Match  m;
+      m.count  = 0;
+      m.option = -1;
+      m.found  = completed;
+      LongIndex(prefixTree()).match(0, prefix, m);
+
+      sortIndexes(completed, m.count);
+      for (count = 0; count < m.count; ++count)
+        completion[count] = optionList + completed[count];
+    } // end else if long option
+  } // end else might be an option
+
+  error       = false;
+  errorCount  = 0;
+  errorOutput = output;
+  errorList   = records;
+  return count;
+} // end GetOpt::complete
+
+//--------------------------------------------------------------------
+// Answer a completion request:
+//
+// If the program was run as "prog --complete WORD...", this prints
+// the long options that the last WORD could be completed to (with
+// their leading "--"), one per line, on stdout.
+//
+// Input:
+//   theArgc, theArgv:  The program's arguments (as for process)
+//
+// Returns:
+//   -1:  This isn't a completion request (process theArgv as usual)
+//    0:  Printed at least one completion
+//    1:  There are no completions
+//    2:  The word is the argument of an option that takes one (so
+//        the shell should complete something else, like a file name)
+
+#ifndef GETOPT_NO_STDIO
+int GetOpt::printCompletions(int theArgc, const char* const* theArgv)
+{
+  if (theArgc < 2 || !sameText(theArgv[1], "--complete"))
+    return -1;
+
+  const Option* const*  list;
+  const Option*         argumentOf;
+
+  // "--complete" stands in for the program name:
+  const int  count = complete(theArgc - 1, theArgv + 1, list, argumentOf);
+
+  if (argumentOf) return 2;
+
+  for (int i = 0; i < count; ++i) {
+    fputs(longOptionStart, stdout);
+    fputs(list[i]->longName, stdout);
+    putc('\n', stdout);
+  }
+
+  return count ? 0 : 1;
+} // end GetOpt::printCompletions
+#endif // not GETOPT_NO_STDIO
+
+//====================================================================
+// Subcommands:
+//
+// A program like "tool build --fast" or "tool remote add -f" has
+// commands, each with options of its own.  Set commands to a list of
+// GetOpt::Command, ended by an entry with a NULL name:
+//
+//   static const GetOpt::Command  remoteCommands[] = {
+//     { "add",    remoteAddOptions, NULL, NULL },
+//     { "remove", NULL,             NULL, NULL },
+//     { 0 }
+//   };
+//   static const GetOpt::Command  commands[] = {
+//     { "build",  buildOptions,  NULL,           (void*) doBuild },
+//     { "remote", remoteOptions, remoteCommands, (void*) doRemote },
+//     { 0 }
+//   };
+//
+//   GetOpt  getopt(globalOptions);
+//   getopt.commands = commands;
+//   getopt.process(argc, argv);
+//   const GetOpt::Command*  command = getopt.command();
+//
+// While a command must still be chosen, the first normal argument is
+// taken as its name (and moved ahead of the normal arguments like an
+// option).  An unknown name is an error.  A command's options, and
+// those of the commands it's inside (including the global ones),
+// apply to the rest of the command line.  A short option is looked
+// for in the innermost command first; a long option is too, except
+// that an exact match anywhere beats an abbreviation.
+//
+// Commands may be nested up to maxCommandDepth deep.  Nothing is
+// done for a list of commands until a name is looked up in it, and a
+// command's option tables aren't built until it is chosen, so the
+// time to start doesn't depend on how many commands there are.  Both
+// are kept for the next command line.
+//
+// A command's options use their own found pointers (even if
+// foundFlags is set), and are not set to notFound until the command
+// is chosen.  returningAll, lazy queries, suggestions, completion
+// and occurrences(option) apply only to the global options.
+//
+// Command Member Variables:
+//   name:      The command's name
+//   options:   Its options (ended by an all-zero entry), or NULL
+//   commands:  Its subcommands (as for GetOpt::commands), or NULL
+//   data:      For the program's use (such as a function to call)
+//
+// CommandTable Member Variables:
+//   command, count:
+//     The list of commands, and the number of them
+//   bucket, mask:
+//     A hash table of the names: bucket[h & mask] (or the next
+//     bucket that isn't -1) is the index of the command named h
+//   tables, storage:
+//     The option tables for each command.  tables[i].optionList is
+//     NULL until they've been built.
+//   sub:
+//     The table for each command's subcommands, or NULL until needed
+//
+// Selection Member Variables:
+//   table:  The CommandTable the chosen command is in
+//   index:  Its index in table
+//--------------------------------------------------------------------
+
+struct GetOpt::CommandTable
+{
+  const Command*  command;
+  int             count;
+  int*            bucket;
+  unsigned        mask;
+  Tables*         tables;
+  Storage**       storage;
+  CommandTable**  sub;
+
+  explicit CommandTable(const Command* list);
+  ~CommandTable();
+  int   find(const char* name) const;
+  static unsigned  hash(const char* name);
+}; // end GetOpt::CommandTable
+
+struct GetOpt::Selection
+{
+  CommandTable*  table;
+  int            index;
+}; // end GetOpt::Selection
+
+//--------------------------------------------------------------------
+// Hash a command name (FNV-1a):
+
+unsigned GetOpt::CommandTable::hash(const char* name)
+{
+  uint32_t  h = 2166136261u;
+
+  while (*name) {
+    h ^= static_cast<unsigned char>(*name++);
+    h *= 16777619u;
+  }
+
+  return h;
+} // end GetOpt::CommandTable::hash
+
+//--------------------------------------------------------------------
+// Build the hash table for a list of commands:
+//
+// There are at least twice as many buckets as commands, so a lookup
+// seldom looks at more than one or two.  If two commands have the
+// same name, the first one is used.
+
+GetOpt::CommandTable::CommandTable(const Command* list)
+: command(list),
+  count(0),
+  bucket(NULL),
+  mask(1),
+  tables(NULL),
+  storage(NULL),
+  sub(NULL)
+{
+  while (command[count].name) ++count;
+  while (mask + 1 < 2 * unsigned(count)) mask = 2 * mask + 1;
+
+  GETOPT_TRY {
+    bucket  = new int[mask + 1];
+    tables  = new Tables[count ? count : 1];
+    storage = new Storage*[count ? count : 1];
+    sub     = new CommandTable*[count ? count : 1];
+  } GETOPT_CATCH_ALL {
+    delete [] tables;
+    delete [] storage;
+    delete [] bucket;
+    GETOPT_RETHROW;
+  }
+
+  for (unsigned b = 0; b <= mask; ++b)
+    bucket[b] = -1;
+
+  for (int i = 0; i < count; ++i) {
+    tables[i].optionList = NULL;
+    storage[i] = NULL;
+    sub[i] = NULL;
+
+    if (find(command[i].name) >= 0) continue; // Duplicate name
+
+    unsigned  b = hash(command[i].name) & mask;
+    while (bucket[b] >= 0) b = (b + 1) & mask;
+    bucket[b] = i;
+  } // end for each command
+} // end GetOpt::CommandTable::CommandTable
+
+//--------------------------------------------------------------------
+GetOpt::CommandTable::~CommandTable()
+{
+  for (int i = 0; i < count; ++i) {
+    delete storage[i];
+    delete sub[i];
+  }
+  delete [] sub;
+  delete [] storage;
+  delete [] tables;
+  delete [] bucket;
+} // end GetOpt::CommandTable::~CommandTable
+
+//--------------------------------------------------------------------
+// Look up a command by name:
+//
+// Returns:
+//   The index of the command, or -1 if there is none by that name
+
+int GetOpt::CommandTable::find(const char* name) const
+{
+  for (unsigned b = hash(name) & mask; bucket[b] >= 0; b = (b + 1) & mask)
+    if (sameText(command[bucket[b]].name, name))
+      return bucket[b];
+
+  return -1;
+} // end GetOpt::CommandTable::find
+
+//--------------------------------------------------------------------
+// Return the command that was chosen:
+//
+// Returns:
+//   The innermost command chosen on the command line, or NULL if
+//   none was
+
+const GetOpt::Command* GetOpt::command() const
+{
+  return selectedCount ? command(selectedCount - 1) : NULL;
+} // end GetOpt::command
+
+//--------------------------------------------------------------------
+// Return one of the commands that was chosen:
+//
+// Input:
+//   level:  0 for the command chosen from commands, 1 for the
+//           subcommand chosen from its commands, and so on (must be
+//           less than commandCount())
+
+const GetOpt::Command* GetOpt::command(int level) const
+{
+  const Selection&  s = selection[level];
+
+  return s.table->command + s.index;
+} // end GetOpt::command
+
+//--------------------------------------------------------------------
+// Return the option tables of a chosen command:
+//
+// Input:
+//   level:  As for command
+
+const GetOpt::Tables& GetOpt::commandTables(int level) const
+{
+  const Selection&  s = selection[level];
+
+  return s.table->tables[s.index];
+} // end GetOpt::commandTables
+
+//--------------------------------------------------------------------
+// Determine whether the next normal argument names a command:
+
+bool GetOpt::choosingCommand() const
+{
+  if (!selectedCount) return commands != NULL;
+
+  return (selectedCount < maxCommandDepth &&
+          command(selectedCount - 1)->commands);
+} // end GetOpt::choosingCommand
+
+//--------------------------------------------------------------------
+// Choose a command:
+//
+// This looks the name up in the commands that are being chosen from
+// (see choosingCommand), builds the command's option tables if this
+// is the first time it has been chosen, and sets the found flags of
+// its options to notFound.
+//
+// Input:
+//   name:  The argument that names the command
+//
+// Returns:
+//   true:   The command was chosen
+//   false:  There is no such command (the error has been reported)
+
+bool GetOpt::selectCommand(const char* name)
+{
+  CommandTable*  table;
+
+  if (!selectedCount) {
+    if (commandTable && commandTable->command != commands) {
+      delete commandTable;      // commands has been changed
+      commandTable = NULL;
+    }
+    if (!commandTable) commandTable = new CommandTable(commands);
+    table = commandTable;
+  } else {
+    const Selection&  s = selection[selectedCount - 1];
+    if (!s.table->sub[s.index])
+      s.table->sub[s.index] = new CommandTable(s.table->command[s.index]
+                                               .commands);
+    table = s.table->sub[s.index];
+  }
+
+  const int  index = table->find(name);
+
+  if (index < 0) {
+    report(unknownCommand, name, " is not a recognized command");
+    return false;
+  }
+
+  Tables&  tables = table->tables[index];
+
+  if (!tables.optionList) {
+    static const Option  noOptions[1] = { };
+    const Option*  list = table->command[index].options;
+    Tables         built;
+
+    table->storage[index] = build(list ? list : noOptions, built,
+                                  longIndex != NULL);
+    tables = built;
+  } // end if first time this command was chosen
+
+  for (int i = 0; i < tables.foundCount; ++i) {
+    Found* const  flag = tables.foundList[i];
+#ifndef GETOPT_NO_CHECKPOINTS
+    if (foundLogCount >= 0 && *flag) logFound(flag);
+#endif
+    *flag = notFound;
+  }
+
+  if (!selection) selection = new Selection[maxCommandDepth];
+  selection[selectedCount].table = table;
+  selection[selectedCount].index = index;
+  ++selectedCount;
+
+  return true;
+} // end GetOpt::selectCommand
+
+#ifndef GETOPT_NO_MODULES
+//====================================================================
+// Option modules:
+//
+// A program made of parts that each have options (like plugins) can
+// give each part's list to addOptions, instead of joining them into
+// one list for the constructor:
+//
+//   GetOpt  getopt(mainOptions);
+//   GetOpt::Conflict  conflict[4];
+//
+//   const int  count = getopt.addOptions(plugin->options(), conflict, 4);
+//   for (int i = 0; i < count && i < 4; ++i)
+//     warn(plugin, conflict[i].option, conflict[i].existing);
+//
+// The lists are not copied, so they must exist until they are
+// removed (or the GetOpt is destroyed), and the options GetOpt
+// returns are the ones in them.  A module's options are found just
+// like the global ones (after them, and after any chosen command's).
+//
+// The long names of all the modules go into one prefix tree (see
+// fillIndex), so a lookup costs the same however many modules there
+// are.  Adding a list adds its names to the tree, and removing one
+// takes them out, so either takes time proportional to the size of
+// that list.  Since removed names leave their slots behind, the tree
+// is built again from the remaining lists once there are more unused
+// slots than used ones.
+//
+// A list is added only if none of its options conflicts with an
+// option already known (a global one, or one from another module):
+//   sameShortName:  They have the same single-character name.
+//   sameLongName:   They have the same long name.
+//   prefixName:     One long name starts with the other, so the
+//                   shorter one can't be abbreviated.
+// Options in the same list are not checked against each other (as
+// for the constructor's list).
+//
+// A module's options use their own found pointers (even if
+// foundFlags is set), which init sets to notFound.  An entry with an
+// empty long name is ignored (returningAll comes only from the global
+// options), and as for commands, lazy queries, suggestions,
+// completion and occurrences(option) apply only to the global
+// options.  Modules must not be added or removed while a command
+// line is being processed.
+//
+// Conflict Member Variables:
+//   kind:      Why they conflict (as above)
+//   option:    The option in the list being added
+//   existing:  The option it conflicts with
+//
+// ModuleIndex Member Variables:
+//   list, listCount, listSize:
+//     The lists that have been added, in order.  list has room for
+//     listSize entries.
+//   firstSlot, slotCount:
+//     firstSlot[i] is the slot of the first option in list[i].  Its
+//     options have consecutive slots.
+//   option, optionSize, usedSlots:
+//     option[s] is the option in slot s, or NULL if its list was
+//     removed.  option has room for optionSize entries.  usedSlots is
+//     the number that are not NULL.
+//   node, nodeCount, nodeSize:
+//     The prefix tree of every module's long names, with its exact
+//     and first members being slots.  A node whose count is 0 is left
+//     over from a removed name, and is ignored.  node has room for
+//     nodeSize nodes.
+//   shortOption:
+//     shortOption[c] is the module option whose shortName is c (taken
+//     as an unsigned char), or NULL if there is none
+//--------------------------------------------------------------------
+
+struct GetOpt::ModuleIndex
+{
+  const Option**  list;
+  int*            firstSlot;
+  int             listCount, listSize;
+  const Option**  option;
+  int             slotCount, optionSize, usedSlots;
+  IndexNode*      node;
+  int             nodeCount, nodeSize;
+  const Option*   shortOption[256];
+
+  ModuleIndex();
+  ~ModuleIndex();
+
+  static int  clash(const IndexNode* tree, const char* name,
+                    Conflict::Kind& kind);
+  void  add(const Option* aList);
+  void  remove(int index);
+  int   find(const char* name) const;
+  void  insert(const char* name, int slot);
+  void  erase(const char* name, int slot);
+  int   anyBelow(int n) const;
+  void  clearFound() const;
+}; // end GetOpt::ModuleIndex
+
+//--------------------------------------------------------------------
+// Constructor:
+
+GetOpt::ModuleIndex::ModuleIndex()
+: list(NULL),
+  firstSlot(NULL),
+  listCount(0), listSize(0),
+  option(NULL),
+  slotCount(0), optionSize(0), usedSlots(0),
+  node(new IndexNode[64]),
+  nodeCount(1), nodeSize(64)
+{
+  node[0].firstChild = node[0].nextSibling = -1;
+  node[0].exact = node[0].first = -1;
+  node[0].count = 0;
+  node[0].ch    = 0;
+
+  for (int c = 0; c < 256; ++c)
+    shortOption[c] = NULL;
+} // end GetOpt::ModuleIndex::ModuleIndex
+
+//--------------------------------------------------------------------
+// Destructor:
+
+GetOpt::ModuleIndex::~ModuleIndex()
+{
+  delete [] node;
+  delete [] option;
+  delete [] firstSlot;
+  delete [] list;
+} // end GetOpt::ModuleIndex::~ModuleIndex
+
+//--------------------------------------------------------------------
+// Find an option whose long name conflicts with a new one:
+//
+// Input:
+//   tree:  A prefix tree (see fillIndex)
+//   name:  The long name to be added
+//
+// Output:
+//   kind:  sameLongName or prefixName (if there's a conflict)
+//
+// Returns:
+//   The index (as used by tree) of the conflicting option, or -1 if
+//   there isn't one
+
+int GetOpt::ModuleIndex::clash(const IndexNode* tree, const char* name,
+                               Conflict::Kind& kind)
+{
+  const LongIndex  index(tree);
+  int  n = 0;
+
+  for (const char* c = name; *c; ++c) {
+    if ((n = index.child(n, *c)) < 0) return -1;
+    if (c[1] && tree[n].exact >= 0) {
+      kind = Conflict::prefixName; // An existing name is a prefix of this
+      return tree[n].exact;
+    }
+  } // end for each character in name
+
+  if (tree[n].exact >= 0) {
+    kind = Conflict::sameLongName;
+    return tree[n].exact;
+  }
+  if (tree[n].count > 0) {
+    kind = Conflict::prefixName;   // This is a prefix of existing names
+    return tree[n].first;
+  }
+
+  return -1;
+} // end GetOpt::ModuleIndex::clash
+
+//--------------------------------------------------------------------
+// Add a list's options to the tables:
+//
+// Input:
+//   aList:  The option list (which has already been checked)
+
+void GetOpt::ModuleIndex::add(const Option* aList)
+{
+  const int  count = countOptions(aList);
+
+  if (listCount == listSize) {
+    const int       newSize = listSize ? 2 * listSize : 8;
+    const Option**  newList = new const Option*[newSize];
+    int*            newFirst;
+    GETOPT_TRY {
+      newFirst = new int[newSize];
+    } GETOPT_CATCH_ALL {
+      delete [] newList;
+      GETOPT_RETHROW;
+    }
+    if (listCount) {
+      memcpy(newList, list, listCount * sizeof(*list));
+      memcpy(newFirst, firstSlot, listCount * sizeof(*firstSlot));
+    }
+    delete [] list;
+    delete [] firstSlot;
+    list      = newList;
+    firstSlot = newFirst;
+    listSize  = newSize;
+  } // end if list is full
+
+  if (slotCount + count > optionSize) {
+    int  newSize = optionSize ? 2 * optionSize : 64;
+    while (newSize < slotCount + count) newSize *= 2;
+    const Option**  newOption = new const Option*[newSize];
+    if (slotCount)
+      memcpy(newOption, option, slotCount * sizeof(*option));
+    delete [] option;
+    option     = newOption;
+    optionSize = newSize;
+  } // end if option is full
+
+  list[listCount]        = aList;
+  firstSlot[listCount++] = slotCount;
+
+  for (int i = 0; i < count; ++i) {
+    const Option&  o = aList[i];
+    const int      slot = slotCount++;
+
+    option[slot] = &o;
+    if (o.shortName && !shortOption[static_cast<unsigned char>(o.shortName)])
+      shortOption[static_cast<unsigned char>(o.shortName)] = &o;
+    if (o.longName && *o.longName && find(o.longName) < 0)
+      insert(o.longName, slot);
+  } // end for each option
+
+  usedSlots += count;
+} // end GetOpt::ModuleIndex::add
+
+//--------------------------------------------------------------------
+// Remove a list's options from the tables:
+//
+// Input:
+//   index:  The index of the list in list
+
+void GetOpt::ModuleIndex::remove(int index)
+{
+  const Option* const  gone = list[index];
+  const int            first = firstSlot[index];
+  const int            count = countOptions(gone);
+
+  for (int i = 0; i < count; ++i) {
+    const Option&  o = gone[i];
+
+    option[first + i] = NULL;
+    if (shortOption[static_cast<unsigned char>(o.shortName)] == &o)
+      shortOption[static_cast<unsigned char>(o.shortName)] = NULL;
+    if (o.longName && *o.longName && find(o.longName) == first + i)
+      erase(o.longName, first + i);
+  } // end for each option
+
+  usedSlots -= count;
+  --listCount;
+  memmove(list + index, list + index + 1,
+          (listCount - index) * sizeof(*list));
+  memmove(firstSlot + index, firstSlot + index + 1,
+          (listCount - index) * sizeof(*firstSlot));
+
+  if (slotCount - usedSlots > usedSlots + 64) {
+    // Too many unused slots; build the tree again:
+    const int  remaining = listCount;
+
+    nodeCount = 1;
+    node[0].firstChild = node[0].nextSibling = -1;
+    node[0].exact = node[0].first = -1;
+    node[0].count = 0;
+    listCount = slotCount = usedSlots = 0;
+
+    for (int i = 0; i < remaining; ++i)
+      add(list[i]);
+  } // end if time to compact the slots
+} // end GetOpt::ModuleIndex::remove
+
+//--------------------------------------------------------------------
+// Look up a long name exactly:
+//
+// Input:
+//   name:  The long name
+//
+// Returns:
+//   The slot of the option with that name, or -1 if there is none
+
+int GetOpt::ModuleIndex::find(const char* name) const
+{
+  const LongIndex  index(node);
+  int  n = 0;
+
+  while (n >= 0 && *name)
+    n = index.child(n, *name++);
+
+  return (n >= 0) ? node[n].exact : -1;
+} // end GetOpt::ModuleIndex::find
+
+//--------------------------------------------------------------------
+// Add a long name to the prefix tree:
+//
+// This is one step of fillIndex, except that nodes left over from
+// removed names are used again.  A list with two options of the same
+// name has only the first one added (as for fillIndex).
+//
+// Input:
+//   name:  The long name (not empty, and not in the tree)
+//   slot:  The slot of its option
+
+void GetOpt::ModuleIndex::insert(const char* name, int slot)
+{
+  int  n = 0;
+
+  for (const char* o = name;; ++o) {
+    if (!node[n].count++) node[n].first = slot;
+    if (!*o) break;
+
+    int  c = node[n].firstChild;
+    while (c >= 0 && node[c].ch != *o)
+      c = node[c].nextSibling;
+
+    if (c < 0) {
+      if (nodeCount == nodeSize) {
+        IndexNode*  newNode = new IndexNode[2 * nodeSize];
+        memcpy(newNode, node, nodeCount * sizeof(*node));
+        delete [] node;
+        node = newNode;
+        nodeSize *= 2;
+      } // end if node is full
+
+      c = nodeCount++;
+      node[c].firstChild = -1;
+      node[c].nextSibling = node[n].firstChild;
+      node[c].exact = node[c].first = -1;
+      node[c].count = 0;
+      node[c].ch    = *o;
+      node[n].firstChild = c;
+    } // end if new node
+    n = c;
+  } // end for each character in name
+
+  node[n].exact = slot;
+} // end GetOpt::ModuleIndex::insert
+
+//--------------------------------------------------------------------
+// Take a long name out of the prefix tree:
+//
+// The nodes stay, but the counts along the name's path go down, and
+// any first member that was its slot is changed to another slot
+// below that node (or -1 if none is left).
+//
+// Input:
+//   name, slot:  As passed to insert (which must have added it)
+
+void GetOpt::ModuleIndex::erase(const char* name, int slot)
+{
+  const LongIndex  index(node);
+  int  n = 0;
+
+  // First get the counts right:
+  for (const char* o = name;; ++o) {
+    --node[n].count;
+    if (!*o) break;
+    n = index.child(n, *o);
+  }
+  node[n].exact = -1;
+
+  // Then the first members along the path:
+  n = 0;
+  for (const char* o = name;; ++o) {
+    if (!node[n].count)
+      node[n].first = -1;
+    else if (node[n].first == slot)
+      node[n].first = anyBelow(n);
+    if (!*o) break;
+    n = index.child(n, *o);
+  }
+} // end GetOpt::ModuleIndex::erase
+
+//--------------------------------------------------------------------
+// Find a name that ends at or below a node:
+//
+// Input:
+//   n:  A node whose count is not 0
+//
+// Returns:
+//   The slot of one such name
+
+int GetOpt::ModuleIndex::anyBelow(int n) const
+{
+  while (node[n].exact < 0) {
+    n = node[n].firstChild;
+    while (!node[n].count)
+      n = node[n].nextSibling;
+  }
+
+  return node[n].exact;
+} // end GetOpt::ModuleIndex::anyBelow
+
+//--------------------------------------------------------------------
+// Set the found flags of every module's options to notFound:
+
+void GetOpt::ModuleIndex::clearFound() const
+{
+  for (int s = 0; s < slotCount; ++s)
+    if (option[s] && option[s]->found)
+      *(option[s]->found) = notFound;
+} // end GetOpt::ModuleIndex::clearFound
+
+//--------------------------------------------------------------------
+// Add a list of options:
+//
+// Input:
+//   list:
+//     The options, ended by an all-zero entry.  This is not copied,
+//     and must exist until it is removed.
+//   max:
+//     The most conflicts to store in conflicts
+//
+// Output:
+//   conflicts:
+//     The conflicts found, if any (see Option modules).  Must have
+//     room for max, or may be NULL if max is 0.
+//
+// Returns:
+//   The number of conflicts (which may be more than max).  The list
+//   was added only if this is 0.
+
+int GetOpt::addOptions(const Option* list, Conflict* conflicts, int max)
+{
+  if (!modules) modules = new ModuleIndex;
+  ModuleIndex&  m = *modules;
+
+  const IndexNode* const  global = prefixTree();
+  int  count = 0;
+
+  for (int i = 0; list[i].shortName || list[i].longName; ++i) {
+    const Option&   o = list[i];
+    Conflict::Kind  kind = Conflict::sameShortName;
+    const Option*   existing = NULL;
+
+    if (o.shortName) {
+      const unsigned char  c = static_cast<unsigned char>(o.shortName);
+      existing = shortOption[c] ? shortOption[c] : m.shortOption[c];
+    }
+
+    if (!existing && o.longName && *o.longName) {
+      int  index = ModuleIndex::clash(global, o.longName, kind);
+      if (index >= 0)
+        existing = optionList + index;
+      else if ((index = ModuleIndex::clash(m.node, o.longName, kind)) >= 0)
+        existing = m.option[index];
+    } // end if option has a long name
+
+    if (existing) {
+      if (count < max) {
+        conflicts[count].kind     = kind;
+        conflicts[count].option   = &o;
+        conflicts[count].existing = existing;
+      }
+      ++count;
+    }
+  } // end for each option
+
+  if (!count) m.add(list);
+
+  return count;
+} // end GetOpt::addOptions
+
+//--------------------------------------------------------------------
+// Remove a list of options:
+//
+// Input:
+//   list:  A list that was passed to addOptions
+//
+// Returns:
+//   true:   The list was removed
+//   false:  The list had not been added
+
+bool GetOpt::removeOptions(const Option* list)
+{
+  if (modules)
+    for (int i = 0; i < modules->listCount; ++i)
+      if (modules->list[i] == list) {
+        modules->remove(i);
+        return true;
+      }
+
+  return false;
+} // end GetOpt::removeOptions
+
+//--------------------------------------------------------------------
+// Look up a long option in the modules:
+//
+// Input:
+//   option:  As for findLongOption
+//
+// Output:
+//   ambiguous:  true if more than one option might match
+//
+// Returns:
+//   A pointer to the corresponding GetOpt::Option
+//   NULL if no option matched, or more than one might have
+
+const GetOpt::Option* GetOpt::findModuleOption(const char* option,
+                                               bool& ambiguous)
+{
+  const LongIndex  tree(modules->node);
+  const int        slot = tree.find(option, ambiguous);
+
+#ifdef GETOPT_STATS
+  stats.optionsScanned  += tree.scanned;
+  stats.charsCompared   += tree.compared;
+  stats.ambiguityChecks += tree.searched;
+#endif
+
+  return (slot >= 0) ? modules->option[slot] : NULL;
+} // end GetOpt::findModuleOption
+#endif // not GETOPT_NO_MODULES
+
+//====================================================================
+// Collecting errors:
+//
+// Normally, each error is passed to errorOutput as it happens, and
+// processing stops at the first one.  To check a command line for
+// every mistake instead, give GetOpt somewhere to record them:
+//
+//   GetOpt::ErrorRecord  errors[16];
+//   getopt.errorList     = errors;
+//   getopt.errorListSize = 16;
+//   getopt.process(argc, argv);
+//   for (int i = 0; i < getopt.errorCount && i < 16; ++i) ...
+//
+// errorOutput is then never called, and nothing is allocated or
+// formatted when an error happens.  An unknown, ambiguous or
+// repeated option, or one with a missing or bad argument, is skipped
+// (along with the argument it would have taken) and processing goes
+// on.  Other errors, such as an unknown command or a response file
+// that can't be read, still stop it.  errorCount counts every error
+// (even the ones that didn't fit in errorList), and is reset by init.
+//
+// formatError turns a record into the message that errorOutput would
+// have been given, when and if it's wanted.
+//
+// ErrorRecord Member Variables:
+//   code:
+//     What went wrong.  An error reported by an argument callback is
+//     invalidArgument; one reported by the program is otherError.
+//   position:
+//     The index in argv (as for currentArg) of the argument that was
+//     being processed
+//   offset:
+//     For a single-character option, the index in that argument of
+//     the option character.  Otherwise 0.
+//   option:
+//     The option that was being processed, or NULL if it wasn't known
+//   text:
+//     The argument, as typed (or for badSource, the file's name)
+//   message:
+//     The message that reportError was given, like " is ambiguous"
+//   candidate, candidateCount:
+//     For ambiguousOption, the options it could have meant.
+//     candidateCount may be more than maxCandidates, but only that
+//     many are stored.
+//--------------------------------------------------------------------
+// Record (or print) an error:
+//
+// Input:
+//   code:     What went wrong
+//   option:   The option that caused a problem
+//   message:  The problem that was encountered
+//   which:    The Option that caused a problem, or NULL
+
+void GetOpt::report(ErrorCode code, const char* option, const char* message,
+                    const Option* which)
+{
+#ifndef GETOPT_NO_THREADS
+  if (conversion) {             // Reported later (see Parallel conversion)
+    holdError(option, message);
+    return;
+  }
+#endif
+
+  error = true;
+
+  ErrorRecord*  record = NULL;
+
+  if (!errorList) {
+    if (!deferring) {
+      if (errorOutput)
+        (*errorOutput)(option, message);
+    } else if (!heldError.text)
+      record = &heldError;      // Reported after the deferred callbacks
+  } else if (reportAt >= 0) {
+    // Insert it before the errors found after it:
+    if (reportAt < errorListSize) {
+      const int  stored = ((errorCount < errorListSize)
+                           ? errorCount : errorListSize - 1);
+      if (stored > reportAt)
+        memmove(errorList + reportAt + 1, errorList + reportAt,
+                (stored - reportAt) * sizeof(*errorList));
+      record = errorList + reportAt;
+    }
+    ++reportAt;
+  } else if (errorCount < errorListSize)
+    record = errorList + errorCount;
+
+  if (record) {
+    ErrorRecord&  e = *record;
+
+    e.code     = code;
+    e.position = argi;
+    e.offset   = 0;
+    e.option   = which;
+    e.text     = option;
+    e.message  = message;
+    e.candidateCount = 0;
+
+    if (option == shortOptionBuf) { // It won't last, so point into curArg
+      e.text   = curArg;
+      e.offset = chari;
+    }
+  } // end if recording it
+
+  ++errorCount;
+} // end GetOpt::report
+
+//--------------------------------------------------------------------
+// Append text to a message, as far as it fits:
+
+static void appendText(char* buffer, int size, int& length,
+                       const char* text, int n)
+{
+  for (int i = 0; i < n; ++i, ++length)
+    if (length < size - 1)
+      buffer[length] = text[i];
+} // end appendText
+
+//--------------------------------------------------------------------
+// Format the message for a recorded error:
+//
+// The message is the same as errorOutput would have printed
+// (including suggestions for an unknown long option, if suggestions
+// is set), except that an ambiguous option lists its candidates.
+//
+// Input:
+//   record:  The error
+//   size:    The size of buffer
+//
+// Output:
+//   buffer:
+//     The message, cut short if necessary to fit (always ended by a
+//     NUL, unless size is 0)
+//
+// Returns:
+//   The length of the whole message (not counting the NUL)
+
+int GetOpt::formatError(const ErrorRecord& record, char* buffer, int size)
+{
+  const char*  text    = record.text;
+  const char*  message = record.message;
+  int          length  = 0;
+
+  if (record.offset) {          // -x from a bundle
+    appendText(buffer, size, length, text, 1);
+    appendText(buffer, size, length, text + record.offset, 1);
+  } else
+    appendText(buffer, size, length, text, int(textLength(text)));
+
+  if (record.code == unknownOption && !record.offset &&
+      startsWith(text, longOptionStart))
+    message = unrecognized(text + sizeof(longOptionStart) - 1);
+
+  appendText(buffer, size, length, message, int(textLength(message)));
+
+  if (record.code == ambiguousOption && record.candidateCount) {
+    const int  count = (record.candidateCount < ErrorRecord::maxCandidates)
+      ? record.candidateCount : int(ErrorRecord::maxCandidates);
+
+    appendText(buffer, size, length, " (", 2);
+    for (int i = 0; i < count; ++i) {
+      const char* const  name = record.candidate[i]->longName;
+      if (i)
+        appendText(buffer, size, length, ", ", 2);
+      appendText(buffer, size, length, longOptionStart,
+                 sizeof(longOptionStart) - 1);
+      appendText(buffer, size, length, name, int(textLength(name)));
+    }
+    if (count < record.candidateCount)
+      appendText(buffer, size, length, ", ...", 5);
+    appendText(buffer, size, length, ")", 1);
+  } // end if listing candidates
+
+  if (size > 0)
+    buffer[(length < size) ? length : size - 1] = 0;
+
+  return length;
+} // end GetOpt::formatError
+
+//====================================================================
+// Instrumentation:
+//
+// Built with GETOPT_STATS, GetOpt counts the work it does while it
+// parses, to show why a command line is slow to process:
+//
+//   getopt.process(argc, argv);
+//   printf("%ld names compared\n", getopt.stats.optionsScanned);
+//
+// The counts in stats start over at each init.  They are:
+//   longLookups, shortLookups:
+//     Long and single-character options looked up
+//   optionsScanned:
+//     Names compared with a long option (or nodes of the index looked
+//     at, if there is one), and option lists tried for a
+//     single-character option
+//   charsCompared:
+//     Characters compared while looking up long options
+//   ambiguityChecks:
+//     Searches for every option an abbreviation might mean (for a
+//     long option that isn't exactly any option's name)
+//   argsMoved:
+//     Arguments moved to put the options before the normal arguments
+//   callbacks:
+//     Argument callbacks called
+//   callbackTime:
+//     Nanoseconds spent in them (always 0 with GETOPT_FREESTANDING,
+//     which has no clock).  Reading the clock twice per callback is
+//     most of what GETOPT_STATS costs.
+//
+// If traceOutput is not NULL, it's called after each option (or
+// normal argument) has been handled, with type traceOption, and after
+// each callback, with type traceCallback.  The Trace's cost says how
+// much each count went up (for traceOption, that includes the
+// callback).  Callbacks called by parallel conversion are counted,
+// but not traced.
+//
+// Without GETOPT_STATS, none of this is compiled.
+//--------------------------------------------------------------------
+// Return the time in nanoseconds (from some fixed point):
+
+#ifdef GETOPT_STATS
+static int64_t clockTime()
+{
+#ifdef GETOPT_FREESTANDING
+  return 0;
+#else
+  struct timespec  now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return int64_t(now.tv_sec) * 1000000000 + now.tv_nsec;
+#endif
+} // end clockTime
+
+//--------------------------------------------------------------------
+// Pass something that happened to traceOutput:
+//
+// Input:
+//   type, option, asEntered, position:
+//     Copied to the Trace
+//   before:
+//     stats before it happened
+
+void GetOpt::trace(TraceType type, const Option* option,
+                   const char* asEntered, int position, const Stats& before)
+{
+  if (!traceOutput) return;
+
+  Trace  t;
+
+  t.type      = type;
+  t.option    = option;
+  t.asEntered = asEntered;
+  t.position  = position;
+  t.cost.longLookups     = stats.longLookups     - before.longLookups;
+  t.cost.shortLookups    = stats.shortLookups    - before.shortLookups;
+  t.cost.optionsScanned  = stats.optionsScanned  - before.optionsScanned;
+  t.cost.charsCompared   = stats.charsCompared   - before.charsCompared;
+  t.cost.ambiguityChecks = stats.ambiguityChecks - before.ambiguityChecks;
+  t.cost.argsMoved       = stats.argsMoved       - before.argsMoved;
+  t.cost.callbacks       = stats.callbacks       - before.callbacks;
+  t.cost.callbackTime    = stats.callbackTime    - before.callbackTime;
+
+  (*traceOutput)(this, t);
+} // end GetOpt::trace
+#endif // GETOPT_STATS
+
+#ifndef GETOPT_NO_THREADS
+//====================================================================
+// Parallel conversion:
+//
+// A program that gets a great many arguments that each need real
+// work from their callback (parsing numbers, or checking that a file
+// exists) can have process spread that work over several threads:
+//
+//   getopt.conversionThreads = 0;        // One per processor
+//   getopt.process(argc, argv);
+//
+// process then works in two steps.  First it goes through the command
+// line as usual, deciding which arguments are options and which
+// argument each one takes, but it puts off calling the callbacks
+// that convert arguments.  Then it runs those callbacks on the
+// threads, each thread taking the next few of them as it finishes
+// the last few, so a slow one doesn't hold up the rest.  (nextOption
+// and processBatch never put anything off.)
+//
+// Only the callbacks of options with the concurrent flag are put
+// off, and only where they can't change how the command line is
+// read.  The option must be repeatable (one that can't be repeated
+// has nothing to gain, and whether it has been can't wait) and have
+// needArg, and its argument must not be adjacent to it in a bundle
+// (where the callback decides how many characters to use).  Typed
+// options (see bind) are never put off, and neither is an argument
+// read from a source whose arguments don't last until the callbacks
+// run (see ArgSource::lasting), such as a StreamSource.  The rest
+// are converted right away, in order:
+//
+//   { 0, "", NULL,
+//     GetOpt::needArg | GetOpt::repeatable | GetOpt::concurrent,
+//     checkFile },
+//
+// A concurrent callback may be called on any thread, at the same
+// time as any other (including itself, for another occurrence), and
+// in any order, so it must not change anything that another callback
+// uses without a lock.  That rules out the standard callbacks, which
+// store their argument in one variable.  It should report errors
+// only through reportError (not by setting error), with text that
+// lasts until process returns (asEntered and a string literal, say),
+// and must not throw.
+//
+// Errors are still reported in the order of the command line.  While
+// the callbacks run, report only holds on to each error, along with
+// the callback that reported it; afterwards they're reported on this
+// thread, in order.  Without errorList, only the first error is passed
+// to errorOutput, and process returns the position of the option
+// that had it; but the command line has still been read to the end,
+// and the callbacks of later options have been called.  As usual,
+// an occurrence with a bad argument isn't captured, and an option
+// counts as found only if one of its occurrences was good.
+//
+// Deferred Member Variables:
+//   option:      The option
+//   curArg:      The argument that contained it
+//   argument:    Its argument
+//   flag:        Its found flag, or NULL
+//   connected:   How argument was connected to it
+//   position, offset:
+//     argi and chari when it was found
+//   occurrence:  Its index in occurrence, or -1 if it isn't captured
+//   errorsBefore:
+//     The number of errors reported before it was found
+//   shortName:   asEntered for a single-character option, or ""
+//   converted:   true if its callback succeeded
+//   errors, lastError:
+//     The first and last of the errors its callback reported (NULL
+//     if none).  Each error's text and message are as it passed them
+//     to report.
+//
+// Conversion Member Variables:
+//   getopt:   The GetOpt whose deferred callbacks are being run
+//   next:     The index in deferred of the next one not yet taken
+//   lock:     Protects next
+//   current:  The Deferred whose callback each thread is calling
+//   keyed:    True if current could be created.  If not, only one
+//             thread runs, and its Deferred is in alone.
+//   alone:    The Deferred being called, when not keyed
+//--------------------------------------------------------------------
+
+struct GetOpt::Deferred
+{
+  const Option*  option;
+  const char*    curArg;
+  const char*    argument;
+  Found*         flag;
+  Connection     connected;
+  int            position, offset;
+  int            occurrence;
+  int            errorsBefore;
+  char           shortName[3];
+  bool           converted;
+  struct HeldError
+  {
+    HeldError*   next;
+    const char*  text;
+    const char*  message;
+  };
+  HeldError*     errors;
+  HeldError*     lastError;
+
+  const char*  asEntered() const { return shortName[0] ? shortName : curArg; }
+}; // end GetOpt::Deferred
+
+struct GetOpt::Conversion
+{
+  GetOpt*          getopt;
+  int              next;
+  pthread_mutex_t  lock;
+  pthread_key_t    current;
+  bool             keyed;
+  Deferred*        alone;
+
+  explicit Conversion(GetOpt* aGetopt)
+  : getopt(aGetopt), next(0), keyed(false), alone(NULL)
+  {
+    pthread_mutex_init(&lock, NULL);
+  }
+
+  ~Conversion() { pthread_mutex_destroy(&lock); }
+
+  static void*  run(void* conversion);
+}; // end GetOpt::Conversion
+
+//--------------------------------------------------------------------
+// Determine whether an option's callback can be put off:
+//
+// Input:
+//   option:     The option
+//   usedChars:  As passed to its callback
+//
+// Returns:
+//   true if it can be called after the command line has been read
+
+bool GetOpt::deferrable(const Option* option, const int* usedChars) const
+{
+  return (!usedChars && option->function && option->store <= storeBool &&
+          (!source || source->lasting) &&
+          ((option->flag & (GetOpt::needArg | GetOpt::repeatable |
+                            GetOpt::concurrent)) ==
+           (GetOpt::needArg | GetOpt::repeatable | GetOpt::concurrent)));
+} // end GetOpt::deferrable
+
+//--------------------------------------------------------------------
+// Put off calling an option's callback:
+//
+// This is called from useOption, for the option at argi and chari.
+// The option is captured as usual, but its found flag is left alone
+// until the callback succeeds.
+//
+// Input:
+//   option, asEntered, connected, argument:
+//     As for the callback
+//   flag:
+//     The option's found flag, or NULL
+
+void GetOpt::defer(const Option* option, const char* asEntered,
+                   Connection connected, const char* argument, Found* flag)
+{
+  if (deferredCount == deferredSize) {
+    const int  newSize = deferredSize ? 2 * deferredSize : 64;
+    Deferred*  newDeferred = new Deferred[newSize];
+    if (deferredCount)
+      memcpy(newDeferred, deferred, deferredCount * sizeof(*deferred));
+    delete [] deferred;
+    deferred     = newDeferred;
+    deferredSize = newSize;
+  } // end if deferred is full
+
+  Deferred&  d = deferred[deferredCount++];
+  d.option       = option;
+  d.curArg       = curArg;
+  d.argument     = argument;
+  d.flag         = flag;
+  d.connected    = connected;
+  d.position     = argi;
+  d.offset       = chari;
+  d.occurrence   = (option->flag & GetOpt::capture) ? occurrenceCount : -1;
+  d.errorsBefore = errorCount;
+  d.converted    = false;
+  d.errors       = d.lastError = NULL;
+
+  if (asEntered == shortOptionBuf) // It won't last
+    memcpy(d.shortName, shortOptionBuf, sizeof(d.shortName));
+  else
+    d.shortName[0] = 0;
+} // end GetOpt::defer
+
+//--------------------------------------------------------------------
+// Process a command line, converting the arguments in parallel:
+//
+// This is process after init, when conversionThreads isn't 1.
+//
+// Returns:
+//   As for process
+
+int GetOpt::processDeferred()
+{
+  const Option* option;
+  const char* asEntered;
+
+  deferring = true;
+  while (nextOption(option, asEntered))
+    ;
+  deferring = false;
+
+  convertDeferred();
+
+  return finishDeferred();
+} // end GetOpt::processDeferred
+
+//--------------------------------------------------------------------
+// Call the callbacks that were put off:
+//
+// This uses up to conversionThreads threads (counting this one), but
+// no more than there are batches of work for them.  If a thread
+// can't be started, the others do its share.
+
+void GetOpt::convertDeferred()
+{
+  if (!deferredCount) return;
+
+  int  threads = conversionThreads;
+  if (threads <= 0) {
+    const long  processors = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = (processors > 0) ? int(processors) : 1;
+  }
+
+  const int  batches = ((deferredCount + conversionBatch - 1) /
+                        conversionBatch);
+  if (threads > batches) threads = batches;
+  if (threads > maxConversionThreads) threads = maxConversionThreads;
+
+  Conversion  c(this);
+  pthread_t   thread[maxConversionThreads];
+  int         started = 0;
+
+  c.keyed = !pthread_key_create(&c.current, NULL);
+  if (!c.keyed) threads = 1;    // Then only this thread can hold errors
+
+  conversion = &c;
+
+  while (started < threads - 1 &&
+         !pthread_create(thread + started, NULL, Conversion::run, &c))
+    ++started;
+
+  Conversion::run(&c);          // This thread helps too
+
+  for (int i = 0; i < started; ++i)
+    pthread_join(thread[i], NULL);
+
+  conversion = NULL;
+  if (c.keyed) pthread_key_delete(c.current);
+} // end GetOpt::convertDeferred
+
+//--------------------------------------------------------------------
+// Hold on to an error reported by a deferred callback:
+//
+// This is report while the deferred callbacks are being called.
+//
+// Input:
+//   text, message:  As for report
+
+void GetOpt::holdError(const char* text, const char* message)
+{
+  Deferred*  d = conversion->alone;
+  if (conversion->keyed)
+    d = static_cast<Deferred*>(pthread_getspecific(conversion->current));
+  if (!d) return;               // Not from a callback
+
+  Deferred::HeldError*  held = new Deferred::HeldError;
+  held->next    = NULL;
+  held->text    = text;
+  held->message = message;
+
+  if (d->lastError)
+    d->lastError->next = held;
+  else
+    d->errors = held;
+  d->lastError = held;
+} // end GetOpt::holdError
+
+//--------------------------------------------------------------------
+// Call deferred callbacks until there are none left:
+//
+// Input:
+//   conversion:  The Conversion being run (as a void* for pthreads)
+//
+// Returns:
+//   NULL
+
+void* GetOpt::Conversion::run(void* conversion)
+{
+  Conversion&  c = *static_cast<Conversion*>(conversion);
+  GetOpt&      g = *c.getopt;
+#ifdef GETOPT_STATS
+  long         callbacks = 0;
+  int64_t      time = 0;
+#endif
+
+  for (;;) {
+    pthread_mutex_lock(&c.lock);
+    const int  first = c.next;
+    if (first < g.deferredCount) c.next += conversionBatch;
+#ifdef GETOPT_STATS
+    g.stats.callbacks    += callbacks; // For the last batch
+    g.stats.callbackTime += time;
+    callbacks = 0;
+    time = 0;
+#endif
+    pthread_mutex_unlock(&c.lock);
+
+    if (first >= g.deferredCount) return NULL;
+
+    const int  last = ((first + conversionBatch < g.deferredCount)
+                       ? first + conversionBatch : g.deferredCount);
+
+    for (int i = first; i < last; ++i) {
+      Deferred&  d = g.deferred[i];
+#ifdef GETOPT_STATS
+      const int64_t  started = clockTime();
+#endif
+      if (c.keyed)
+        pthread_setspecific(c.current, &d);
+      else
+        c.alone = &d;
+      d.converted = g.convert(d.option, d.asEntered(), d.connected,
+                              d.argument, NULL);
+#ifdef GETOPT_STATS
+      time += clockTime() - started;
+      ++callbacks;
+#endif
+    }
+  } // end forever
+} // end GetOpt::Conversion::run
+
+//--------------------------------------------------------------------
+// Report the errors from the deferred callbacks:
+//
+// The errors held for each callback that failed are reported (in
+// order), going where they would have if it had been called right
+// away, and its occurrence is removed.  The found flag of each one
+// that succeeded is set.
+//
+// Returns:
+//   The value for process to return
+
+int GetOpt::finishDeferred()
+{
+  const int    savedArgi   = argi;
+  const int    savedChari  = chari;
+  const char*  savedCurArg = curArg;
+  int          result      = argi;
+  int          inserted    = 0;
+  bool         stopped     = false;
+  bool         removed     = false;
+
+  for (int i = 0; i < deferredCount; ++i) {
+    Deferred&  d = deferred[i];
+    if (d.converted) {
+      if (d.flag) *d.flag = withArg;
+      continue;
+    }
+
+    // Without errorList, report only the first error:
+    if (errorList || (!stopped && (!heldError.text ||
+                                   d.position < heldError.position ||
+                                   (d.position == heldError.position &&
+                                    d.offset < heldError.offset)))) {
+      argi   = d.position;
+      chari  = d.offset;
+      curArg = d.curArg;
+
+      const char*  asEntered = d.curArg;
+      if (d.shortName[0]) {
+        memcpy(shortOptionBuf, d.shortName, sizeof(shortOptionBuf));
+        asEntered = shortOptionBuf;
+      }
+
+      const int  reported = errorCount;
+      reportAt = d.errorsBefore + inserted;
+
+      for (Deferred::HeldError* e = d.errors; e; e = e->next)
+        report(invalidArgument,
+               (e->text == d.shortName) ? asEntered : e->text,
+               e->message, d.option);
+      if (errorCount == reported)
+        report(missingArgument, asEntered, " requires an argument",
+               d.option);
+
+      inserted += errorCount - reported;
+      reportAt = -1;
+
+      if (!errorList) {
+        stopped = true;
+        result  = d.position;
+      }
+    } // end if reporting this one
+
+    if (d.occurrence >= 0) {    // It wasn't really used
+      occurrence[d.occurrence].option = NULL;
+      removed = true;
+    }
+
+    while (d.errors) {
+      Deferred::HeldError*  done = d.errors;
+      d.errors = done->next;
+      delete done;
+    }
+  } // end for each deferred callback
+
+  argi   = savedArgi;
+  chari  = savedChari;
+  curArg = savedCurArg;
+
+  if (removed) {
+    int  kept = 0;
+    for (int i = 0; i < occurrenceCount; ++i)
+      if (occurrence[i].option) occurrence[kept++] = occurrence[i];
+    occurrenceCount = kept;
+    groupedCount = -1;
+  }
+
+  // An error from the first step that nothing came before:
+  if (heldError.text && !stopped && errorOutput) {
+    const char*  asEntered = heldError.text;
+    if (heldError.offset) {
+      shortOptionBuf[0] = heldError.text[0];
+      shortOptionBuf[1] = heldError.text[heldError.offset];
+      shortOptionBuf[2] = 0;
+      asEntered = shortOptionBuf;
+    }
+    (*errorOutput)(asEntered, heldError.message);
+  }
+  heldError.text = NULL;
+
+  return result;
+} // end GetOpt::finishDeferred
+#endif // not GETOPT_NO_THREADS
+
+#ifndef GETOPT_NO_CHECKPOINTS
+//====================================================================
+// Checkpoints:
+//
+// A program that parses the same command line over and over as it
+// grows, like a shell that checks each word as it is typed, can save
+// the parse between options and go back to it later, so only the
+// arguments after that point are parsed again:
+//
+//   GetOpt::Checkpoint  saved, latest;
+//   int                 first = -1;
+//
+//   // Each time the line changes, with word[0] through
+//   // word[wordCount-1] the words now (word[0] is the program), and
+//   // changed the index of the first one that's different:
+//   if (first >= 0 && first <= changed) {
+//     // Keep argv[0] to argv[first-1] as GetOpt arranged them, and
+//     // replace only the rest:
+//     for (argc = first; argc < wordCount; ++argc)
+//       argv[argc] = word[argc];
+//     getopt.restore(saved, argc, argv);
+//   } else {
+//     for (argc = 0; argc < wordCount; ++argc)
+//       argv[argc] = word[argc];
+//     getopt.init(argc, argv);
+//     first = -1;
+//   }
+//   while (getopt.nextOption(event)) {
+//     const int  unread = getopt.checkpoint(latest);
+//     if (unread >= 0 && unread <= argc - 1) {
+//       saved = latest;   // Keep the last one before the final word
+//       first = unread;
+//     }
+//   }
+//
+// checkpoint returns the index in argv of the first argument that
+// the parse hasn't looked at.  The arguments before it must be left
+// as GetOpt arranged them (the same array, or a copy of its first
+// entries), but the ones from there on may be replaced, added or
+// removed before restore is called.  restore takes them as they are
+// then, in their original order.  The cost of both is independent of
+// the length of the command line, though parsing the rest still puts
+// back the non-option arguments set aside before the checkpoint (a
+// copy of them, unless returningAll is set).
+//
+// What restore puts back is the parse position, the error state,
+// the non-option arguments that were set aside, the occurrences, the
+// chosen commands and the found flags.  Changes to the found flags
+// are logged from the first checkpoint after init, so restore
+// undoes just the ones made since the checkpoint it goes back to.
+// It doesn't undo what callbacks (or bound variables) did; their
+// options are found again as the rest is parsed, so they should
+// simply overwrite what they stored.  Statistics and lazy queries
+// (see scan) aren't affected.
+//
+// A checkpoint may be taken after init or restore, or after
+// nextOption returns true, but not while reading a response file or
+// a pushed source, or during process with more than one
+// conversionThread.  It is good until the next init (or process),
+// and may be restored any number of times, provided nextOption isn't
+// called again after it has returned false.  restore must be given
+// argv the same way init was (with or without order).
+//
+// Checkpoint Member Variables:
+//   These are the saved GetOpt members of the same names.  Besides
+//   nexti (which checkpoint returns), they are for GetOpt's use.
+//   foundChanges is the length of the found flag log.
+//
+// FoundChange Member Variables:
+//   flag:  A found flag that was changed
+//   was:   Its value before the change
+//--------------------------------------------------------------------
+
+struct GetOpt::FoundChange
+{
+  Found*  flag;
+  Found   was;
+}; // end GetOpt::FoundChange
+
+//--------------------------------------------------------------------
+// Save the state of the parse:
+//
+// Output:
+//   saved:  The parse position, for restore
+//
+// Returns:
+//   The index in argv of the first argument not read yet, or -1 if
+//   a checkpoint can't be taken now (saved is unchanged)
+
+int GetOpt::checkpoint(Checkpoint& saved)
+{
+  if (source || deferring) return -1;
+
+  if (foundLogCount < 0) foundLogCount = 0; // Start logging found flags
+
+  saved.argi            = argi;
+  saved.chari           = chari;
+  saved.nexti           = nexti;
+  saved.curArg          = curArg;
+  saved.normalOnly      = normalOnly;
+  saved.error           = error;
+  saved.errorCount      = errorCount;
+  saved.skippedCount    = skippedCount;
+  saved.sourceArgCount  = sourceArgCount;
+  saved.normalsSeen     = normalsSeen;
+  saved.firstUnseen     = firstUnseen;
+  saved.occurrenceCount = occurrenceCount;
+  saved.selectedCount   = selectedCount;
+  saved.foundChanges    = foundLogCount;
+  saved.setCount        = setCount;
+
+  return nexti;
+} // end GetOpt::checkpoint
+
+//--------------------------------------------------------------------
+// Go back to a checkpoint:
+//
+// Input:
+//   saved:
+//     As set by checkpoint (since the last init)
+//   theArgc, theArgv:
+//     The command line, which must be the same as it was up to
+//     the index checkpoint returned (see Checkpoints)
+
+void GetOpt::restore(const Checkpoint& saved, int theArgc,
+                     const char** theArgv)
+{
+  resume(saved, theArgc, theArgv, NULL);
+} // end GetOpt::restore
+
+//--------------------------------------------------------------------
+// Go back to a checkpoint without changing the command line:
+//
+// Input:
+//   saved:            As set by checkpoint (since the last init)
+//   theArgc, theArgv: As for restore
+//   theOrder:
+//     As for init, with its entries up to the index checkpoint
+//     returned as GetOpt left them
+
+void GetOpt::restore(const Checkpoint& saved, int theArgc,
+                     const char* const* theArgv, int* theOrder)
+{
+  // argv is only read when order is used:
+  resume(saved, theArgc, const_cast<const char**>(theArgv), theOrder);
+} // end GetOpt::restore
+
+//--------------------------------------------------------------------
+// Reset the parsing state to a checkpoint:
+//
+// This is start for restore.
+//
+// Input:
+//   saved:            As for restore
+//   theArgc, theArgv: As for restore
+//   theOrder:         As for restore, or NULL to rearrange theArgv
+
+void GetOpt::resume(const Checkpoint& saved, int theArgc,
+                    const char** theArgv, int* theOrder)
+{
+  argc  = theArgc;
+  argv  = theArgv;
+  order = theOrder;
+  if (order)
+    for (int i = saved.nexti; i < argc; ++i)
+      order[i] = i;
+
+  while (source) {              // Keep their arguments around
+    ArgSource*  done = source;
+    source = done->outer;
+    done->outer = usedSources;
+    usedSources = done;
+  }
+  sourceDepth = 0;
+
+  // Undo the found flags, newest change first:
+  while (foundLogCount > saved.foundChanges) {
+    const FoundChange&  change = foundLog[--foundLogCount];
+    *(change.flag) = change.was;
+  }
+  if (setCount <= optionCount) setCount = saved.setCount;
+
+  argi            = saved.argi;
+  chari           = saved.chari;
+  nexti           = saved.nexti;
+  curArg          = saved.curArg;
+  normalOnly      = saved.normalOnly;
+  error           = saved.error;
+  errorCount      = saved.errorCount;
+  skippedCount    = saved.skippedCount;
+  sourceArgCount  = saved.sourceArgCount;
+  normalsSeen     = saved.normalsSeen;
+  firstUnseen     = saved.firstUnseen;
+  occurrenceCount = saved.occurrenceCount;
+  groupedCount    = -1;
+  selectedCount   = saved.selectedCount;
+  heldError.text  = NULL;
+  reportAt        = -1;
+} // end GetOpt::resume
+
+//--------------------------------------------------------------------
+// Record a found flag's value before it is changed:
+//
+// Input:
+//   flag:  The found flag about to be changed
+
+void GetOpt::logFound(Found* flag)
+{
+  if (foundLogCount == foundLogSize) {
+    const int     newSize = foundLogSize ? 2 * foundLogSize : 64;
+    FoundChange*  newLog = new FoundChange[newSize];
+    if (foundLogCount)
+      memcpy(newLog, foundLog, foundLogCount * sizeof(*foundLog));
+    delete [] foundLog;
+    foundLog     = newLog;
+    foundLogSize = newSize;
+  } // end if foundLog is full
+
+  FoundChange&  change = foundLog[foundLogCount++];
+  change.flag = flag;
+  change.was  = *flag;
+} // end GetOpt::logFound
+#endif // not GETOPT_NO_CHECKPOINTS
+
+//====================================================================
+// Splitting text into arguments:
+//
+// Used for response files and by processBatch.
+//--------------------------------------------------------------------
+// Return true if c separates arguments (whitespace or NUL):
+
+static inline bool isSeparator(char c)
+{
+  return (c == ' ' || (c >= '\t' && c <= '\r') || !c);
+} // end isSeparator
+
+//--------------------------------------------------------------------
+// Unquote an argument in place:
+//
+// Quoting works much like the shell: characters between single
+// quotes are taken literally, and between double quotes a backslash
+// escapes the next character.  Outside quotes, a backslash escapes
+// the next character, and an unquoted separator ends the argument.
+//
+// The unquoted argument is NUL-terminated where it started, so it
+// never needs more room than the original.
+//
+// Input:
+//   pos:  Points to the first character of the argument
+//   end:  The end of the text (*end must be writable)
+//
+// Output:
+//   pos:  Points just past the separator that ended the argument
+
+static void unquoteArgument(char*& pos, char* end)
+{
+  char*  out = pos;
+  char   quote = 0;
+
+  for (; pos < end; ++pos) {
+    char  c = *pos;
+
+    if (quote) {
+      if (c == quote) {
+        quote = 0;
+        continue;
+      }
+      if (c == '\\' && quote == '"' && pos + 1 < end)
+        c = *++pos;
+    } else if (isSeparator(c)) {
+      ++pos;
+      break;                    // End of argument
+    } else if (c == '\'' || c == '"') {
+      quote = c;
+      continue;
+    } else if (c == '\\' && pos + 1 < end)
+      c = *++pos;
+
+    *out++ = c;
+  } // end for each character in argument
+
+  *out = 0;
+} // end unquoteArgument
+
+#ifndef GETOPT_NO_FILES
+//--------------------------------------------------------------------
+// Find the end of an argument without unquoting it:
+//
+// Input:
+//   pos:  Points to the first character of the argument
+//   end:  The end of the text
+//
+// Output:
+//   plain:  true if the argument has no quotes or backslashes (so it
+//           is the same unquoted)
+//
+// Returns:
+//   The separator that ends the argument (or end), which is where
+//   unquoteArgument would stop
+
+static char* argumentEnd(char* pos, const char* end, bool& plain)
+{
+  char  quote = 0;
+
+  plain = true;
+
+  for (; pos < end; ++pos) {
+    const char  c = *pos;
+
+    if (quote) {
+      if (c == quote)
+        quote = 0;
+      else if (c == '\\' && quote == '"' && pos + 1 < end)
+        ++pos;
+    } else if (isSeparator(c))
+      break;                    // End of argument
+    else if (c == '\'' || c == '"') {
+      quote = c;
+      plain = false;
+    } else if (c == '\\') {
+      plain = false;
+      if (pos + 1 < end) ++pos;
+    }
+  } // end for each character in argument
+
+  return pos;
+} // end argumentEnd
+#endif // not GETOPT_NO_FILES
+
+#ifndef GETOPT_NO_FILES
+//====================================================================
+// Class GetOpt::ResponseFile:
+//
+// Reads arguments from a file that is mapped into memory.
+//
+// The arguments are separated by whitespace (or NUL characters), and
+// may be quoted as described for unquoteArgument.
+//
+// The file is mapped privately, and each argument is terminated (and
+// unquoted, if it needs that) in place when it is read, so the
+// arguments returned point straight into the mapping.  Nothing is
+// allocated for them.  Terminating an argument writes a NUL over the
+// separator after it, so the pages read become the process's own
+// copies; an argument that already ends in a NUL and isn't quoted is
+// left alone, so a file written with NUL separators (as by
+// "find -print0") is never written to at all.  The mapping lasts as
+// long as the ResponseFile does.
+//
+// Something that can't be mapped, like a pipe (@/dev/stdin), is read
+// into memory instead, and split the same way.
+//
+// Member Variables:
+//   base:    The start of the mapping or the text read (NULL if
+//            there's neither)
+//   length:  The length of the mapping
+//   mapped:  True if base is a mapping (or else it was allocated)
+//   pos:     Where to look for the next argument
+//   end:     The end of the file's contents
+//--------------------------------------------------------------------
+
+class GetOpt::ResponseFile : public GetOpt::ArgSource
+{
+ public:
+  ResponseFile()
+  : base(NULL), length(0), mapped(false), pos(NULL), end(NULL)
+  {
+    lasting = true;
+  }
+  ~ResponseFile();
+
+  bool  open(const char* filename);
+
+ protected:
+  const char*  read();
+
+ private:
+  char*   base;
+  size_t  length;
+  bool    mapped;
+  char*   pos;
+  char*   end;
+
+  bool  readAll(int fd);
+}; // end GetOpt::ResponseFile
+
+//--------------------------------------------------------------------
+// Map a response file into memory:
+//
+// The mapping is one byte longer than the file, so that the last
+// argument has room for its terminating NUL even when the file ends
+// exactly on a page boundary.  That's done by reserving anonymous
+// memory first and then mapping the file over the start of it.
+//
+// Only a regular file is mapped.  Anything else (a pipe or a
+// terminal, whose size says nothing about what it holds) is read.
+//
+// Input:
+//   filename:  The file to read
+//
+// Returns:
+//   true:   The file is ready to read
+//   false:  The file couldn't be opened, mapped, or read (errno is set)
+
+bool GetOpt::ResponseFile::open(const char* filename)
+{
+  const int  fd = ::open(filename, O_RDONLY);
+  if (fd < 0) return false;
+
+  struct stat  info;
+  if (fstat(fd, &info) < 0) {
+    ::close(fd);
+    return false;
+  }
+
+  if (!S_ISREG(info.st_mode)) {
+    const bool  ok = readAll(fd);
+    const int   saved = errno;
+    ::close(fd);
+    errno = saved;
+    return ok;
+  }
+
+  const size_t  size = info.st_size;
+  if (!size) {                  // Nothing to map
+    ::close(fd);
+    return true;
+  }
+
+  void*  p = mmap(NULL, size + 1, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+  if (p != MAP_FAILED &&
+      mmap(p, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED,
+           fd, 0) == MAP_FAILED) {
+    const int  saved = errno;
+    munmap(p, size + 1);
+    errno = saved;
+    p = MAP_FAILED;
+  }
+
+  const int  saved = errno;
+  ::close(fd);
+  errno = saved;
+  if (p == MAP_FAILED) return false;
+
+  madvise(p, size + 1, MADV_SEQUENTIAL);
+
+  base   = pos = static_cast<char*>(p);
+  end    = base + size;
+  length = size + 1;
+  mapped = true;
+
+  return true;
+} // end GetOpt::ResponseFile::open
+
+//--------------------------------------------------------------------
+// Read everything from a file that can't be mapped:
+//
+// Input:
+//   fd:  The file to read
+//
+// Returns:
+//   true:   The text is in base
+//   false:  A read failed (errno is set)
+
+bool GetOpt::ResponseFile::readAll(int fd)
+{
+  size_t  size = 0, room = 4096;
+  char*   text = new char[room + 1]; // Room for a NUL after the last
+
+  for (;;) {
+    if (size == room) {
+      char*  bigger = new char[2 * room + 1];
+      memcpy(bigger, text, size);
+      delete [] text;
+      text  = bigger;
+      room *= 2;
+    }
+
+    const ssize_t  got = ::read(fd, text + size, room - size);
+
+    if (got > 0)
+      size += got;
+    else if (got == 0)
+      break;
+    else if (errno != EINTR) {
+      const int  saved = errno;
+      delete [] text;
+      errno = saved;
+      return false;
+    }
+  } // end forever
+
+  base = pos = text;
+  end  = text + size;
+
+  return true;
+} // end GetOpt::ResponseFile::readAll
+
+//--------------------------------------------------------------------
+// Unmap (or free) the file:
+
+GetOpt::ResponseFile::~ResponseFile()
+{
+  if (mapped)
+    munmap(base, length);
+  else
+    delete [] base;
+} // end GetOpt::ResponseFile::~ResponseFile
+
+//--------------------------------------------------------------------
+// Read the next argument:
+//
+// Returns:
+//   The next argument (unquoted and NUL-terminated in base)
+//   NULL if there are no more
+
+const char* GetOpt::ResponseFile::read()
+{
+  // Skip whitespace:
+  while (pos < end && isSeparator(*pos))
+    ++pos;
+
+  if (pos >= end) return NULL;
+
+  char* const  arg = pos;
+  bool         plain;
+  char* const  argEnd = argumentEnd(arg, end, plain);
+
+  if (!plain) {
+    unquoteArgument(pos, end);  // Never writes beyond the extra byte
+    return arg;
+  }
+
+  // Write only where there isn't a NUL already, to leave the page be:
+  if (argEnd == end || *argEnd)
+    *argEnd = 0;
+  pos = (argEnd < end) ? argEnd + 1 : argEnd;
+
+  return arg;
+} // end GetOpt::ResponseFile::read
+#endif // not GETOPT_NO_FILES
+
+//====================================================================
+// Class GetOpt::Schema:
+//
+// The lookup tables for an option list, built once at run time (with
+// the index of long options) and never changed afterwards.
+//
+// This is for programs that parse many command lines at once in
+// different threads.  A GetOpt constructed from the schema's tables
+// costs nothing to create and allocates nothing to parse a normal
+// command line, so each thread can keep one on its stack:
+//
+//   static const GetOpt::Schema  schema(options);
+//
+//   // In each thread:
+//   GetOpt::Found  found[optionCount];
+//   Results        results;
+//   GetOpt  getopt(schema.tables());
+//   getopt.foundFlags = found;
+//   getopt.results    = &results;
+//   getopt.process(argc, argv);
+//
+// Setting foundFlags and results (with inResults on the options that
+// store something) keeps each parse from writing to the variables
+// named in the option list, which would otherwise be shared
+// by all the threads.  (Callbacks other than the standard ones must
+// use getopt->optionData for the same reason.)  Nothing else that a
+// GetOpt does touches memory that another GetOpt can see.
+//
+// Member Variables:
+//   theTables:  The tables (pointing into storage)
+//   storage:    Owns the tables
+//--------------------------------------------------------------------
+// Constructor:
+//
+// Input:
+//   aList:
+//     The option list.  This is not copied, and must continue to
+//     exist as long as the Schema does.
+
+GetOpt::Schema::Schema(const Option* aList)
+: storage(NULL)
+{
+  storage = build(aList, theTables, true);
+} // end GetOpt::Schema::Schema
+
+//--------------------------------------------------------------------
+// Destructor:
+
+GetOpt::Schema::~Schema()
+{
+  delete storage;
+} // end GetOpt::Schema::~Schema
+
+//====================================================================
+// Class GetOpt:
+//
+// Member Variables:
+//   error:
+//     true if an error has occurred during option processing
+//     false if everything is ok
+//   errorOutput:
+//     A function which is called to display errors
+//     Set to GetOpt::printError by the GetOpt constructor.
+//     If NULL, errors are reported only by setting error to true.
+//   optionStart:
+//     A string containing the characters that indicate options
+//     Set to "-" by the GetOpt constructor.
+//     Must contain '-' if you expect long options to work.
+//     This applies only to single-character options; "--" is always
+//     the long option indicator.
+//     Programs that want to accept DOS-style options should set this
+//     to "-/".  Note that this string is not disposed of by the
+//     GetOpt object.  It must continue to exist as long as the GetOpt
+//     object does.  (Normally, you would set it to point to a string
+//     literal.)
+//   responseFileStart:
+//     The character that introduces a response file (normally '@'),
+//     or 0 if response files are not recognized.
+//     Set to 0 by the GetOpt constructor.
+//   foundFlags:
+//     If not NULL, the found flags are kept here instead of in the
+//     variables that the Option::found pointers point to:
+//     foundFlags[i] is the flag for optionList[i].  It must have room
+//     for one flag per option.  (An option's found pointer still
+//     decides whether it may be repeated, but is otherwise unused.)
+//     Set to NULL by the GetOpt constructor.
+//   results:
+//     Where the options with the inResults flag store their results.
+//     Their data members are offsets into it (see optionData).
+//     Set to NULL by the GetOpt constructor.
+//   suggestions:
+//     The most long options to suggest when the user types one that
+//     isn't recognized (see unrecognized), or 0 for none.
+//     Set to 0 by the GetOpt constructor.
+//   commands:
+//     The commands that the first normal argument may name, ended by
+//     an entry with a NULL name, or NULL if there are none (see
+//     Subcommands).  It must continue to exist as long as the GetOpt
+//     object does.  Set to NULL by the GetOpt constructor.
+//   errorList, errorListSize:
+//     If errorList is not NULL, errors are recorded in it (which has
+//     room for errorListSize records) instead of being passed to
+//     errorOutput, and processing goes on past the ones it can (see
+//     Collecting errors).  Set to NULL by the GetOpt constructor.
+//   errorCount:
+//     The number of errors since init (whether or not errorList is
+//     set)
+//   conversionThreads:
+//     How many threads process uses to call argument callbacks, or 0
+//     for one per processor.  With more than 1, process reads the
+//     whole command line first and then calls the callbacks in
+//     parallel (see Parallel conversion).  Set to 1 by the GetOpt
+//     constructor.  Ignored by processBatch, and if built with
+//     GETOPT_NO_THREADS.
+//   stats:
+//     Only with GETOPT_STATS: what parsing has done since init (see
+//     Instrumentation)
+//   traceOutput:
+//     Only with GETOPT_STATS: a function to call after each option
+//     and each callback, or NULL (see Instrumentation).  Set to NULL
+//     by the GetOpt constructor.
+//
+// Protected Member Variables:
+//   optionList:
+//     The array of GetOpt::Option objects passed to the constructor
+//   argc, argv:
+//     The parameters passed to main (or similar)
+//   order:
+//     If not NULL, argv is never changed.  Instead, order[k] is the
+//     index in argv of the argument that would be at argv[k] if argv
+//     had been rearranged, and everything below that talks about
+//     argv[k] means argv[order[k]] (see argAt and moveArg).
+//   argi:
+//     The index in argv of the argument currently being processed
+//   chari:
+//     If non-zero, the index in argv[argi] of the option character
+//     currently being processed (for single-character option bundles).
+//   nexti:
+//     The index in argv of the next argument nextOption will look at.
+//     This is argi+1 unless some non-option arguments have been set
+//     aside in skipped.
+//   curArg:
+//     The argument currently being processed.  This is argv[argi],
+//     unless it came from a source.
+//   normalOnly:
+//     True means that all arguments yet to be processed are not options.
+//   returningAll:
+//     Points to the GetOpt::Option that corresponds to normal
+//     non-option arguments, or NULL if GetOpt is to process only
+//     options.
+//   shortOptionBuf:
+//     Used when processing single-character option bundles
+//   skipped, skippedIndex, skippedCount, skippedSize:
+//     The non-option arguments that nextOption has passed over while
+//     looking for options, which belong at argv[argi+1] through
+//     argv[nexti-1].  skipped holds the arguments themselves, or if
+//     order is being used, skippedIndex holds their indexes in argv.
+//     Each has room for skippedSize entries; they are kept from one
+//     command line to the next.
+//   sourceArg, sourceArgBefore, sourceArgCount, sourceArgSize:
+//     The non-option arguments read from sources (which can't be put
+//     back into argv), in order.  sourceArgBefore[k] is the number of
+//     non-option arguments in argv that come before sourceArg[k] (see
+//     positionals).  Each has room for sourceArgSize entries; they
+//     are kept from one command line to the next.
+//   normalsSeen, firstUnseen:
+//     The number of non-option arguments in argv that nextOption has
+//     set aside so far.  One below firstUnseen has been counted
+//     already, and is only being set aside again after
+//     restoreSkipped put it back.
+//   optionCount:
+//     The number of entries in optionList (not counting the all-zero
+//     entry that ends it)
+//   longName:
+//     longName[i] is optionList[i].longName.  Keeping the names
+//     together means a scan for a long option doesn't have to drag
+//     the rest of each Option through the cache.
+//   foundList, foundCount:
+//     The found pointers of the options that have one, so init
+//     doesn't have to look at the whole option list
+//   shortOption:
+//     shortOption[c] is the first option whose shortName is c (taken
+//     as an unsigned char), or NULL if there is none
+//   longIndex:
+//     The prefix tree built by buildIndex (see fillIndex), or NULL if
+//     findLongOption should simply scan longName
+//   storage:
+//     Owns the tables above, unless they were passed to the
+//     constructor already built
+//   source:
+//     The ArgSource that arguments are currently coming from, or NULL
+//     if they are coming from argv.  Its outer member points to the
+//     source to continue with when it is finished.
+//   usedSources:
+//     The sources that have been finished, linked by their outer
+//     members.  They are not deleted until init is called (or the
+//     GetOpt is destroyed), so the arguments from them stay valid.
+//   sourceDepth:
+//     The number of sources in the source list (response files may
+//     not be nested more than maxSourceDepth deep)
+//   lineArgv, lineArgvSize:
+//     The argv that processBatch builds for each line.  It holds
+//     lineArgvSize entries, and is kept from one batch to the next.
+//   occurrence, occurrenceCount, occurrenceSize:
+//     Every occurrence of an option with the capture flag, in the
+//     order they were found.  occurrence has room for occurrenceSize
+//     entries, and is kept from one command line to the next.
+//   grouped, groupedSize, groupEnd, groupedCount:
+//     The occurrences again, sorted by option (see occurrences).
+//     groupEnd[i] is the index in grouped just past the occurrences
+//     of optionList[i].  grouped has room for groupedSize entries.
+//     groupedCount is the occurrenceCount they were sorted for, or
+//     -1 if they haven't been.
+//   scanned, scannedSize, scanEnd:
+//     What scan found out about each argument (see Lazy queries).
+//     scanned has room for scannedSize entries.  scanEnd is the
+//     index of the "--" that ends the options (argc if none), or -1
+//     if it hasn't been found yet.
+//   scanning:
+//     True if the command line was given to scan rather than init
+//   query:
+//     The answers to lazy queries, one for each option
+//   ownIndex:
+//     The prefix tree built by prefixTree for a GetOpt whose Tables
+//     didn't have one, or NULL
+//   completed, completion:
+//     The options found by complete (as indexes, and then as
+//     pointers), with room for every option
+//   suggester:
+//     What suggest needs to find the closest long options, or NULL
+//     if it hasn't been needed yet
+//   positional, positionalCount, positionalSize:
+//     The normal arguments (see positionals), which has room for
+//     positionalSize entries (at least scannedSize).  After scan,
+//     positionalCount is -1 until they've been found.
+//   setFound, setCount:
+//     The found flags that have been changed from notFound since the
+//     last init, so processBatch can reset just those.  setFound has
+//     room for optionCount entries; setCount > optionCount means that
+//     some were missed.  setFound is NULL (and nothing is recorded)
+//     until processBatch is first called.
+//   commandTable:
+//     The CommandTable for commands, or NULL if no command has been
+//     looked up yet
+//   selection, selectedCount:
+//     The commands chosen on this command line, outermost first.
+//     selection has room for maxCommandDepth entries, and is NULL
+//     until a command is first chosen.
+//   deferred, deferredCount, deferredSize:
+//     The callbacks that process has put off (see Parallel
+//     conversion).  deferred has room for deferredSize entries, and
+//     is kept from one command line to the next.
+//   deferring:
+//     True while process is putting off callbacks
+//   conversion:
+//     The Conversion running the deferred callbacks, or NULL.  While
+//     there is one, report holds errors for later.
+//   heldError:
+//     Without errorList, the first error found while deferring
+//     (text is NULL if none), which is reported only if no deferred
+//     callback failed before it
+//   reportAt:
+//     Where report puts the next record in errorList, or -1 for at
+//     the end
+//   foundLog, foundLogCount, foundLogSize:
+//     The found flags changed since the first checkpoint, with their
+//     old values, so restore can change them back (see Checkpoints).
+//     foundLog has room for foundLogSize entries, and is kept from
+//     one command line to the next.  foundLogCount is -1 (and nothing
+//     is logged) until checkpoint is called after init.  Unused if
+//     built with GETOPT_NO_CHECKPOINTS.
+//   modules:
+//     The option lists added by addOptions, and their lookup tables
+//     (see Option modules), or NULL if none has been added yet
+//
+//--------------------------------------------------------------------
+// Constructor:
+//
+// Input:
+//   aList:
+//     An array of GetOpt::Option objects that define the options to
+//     look for.  This array is not copied, and must continue to exist
+//     as long as the GetOpt object does.
+
+GetOpt::GetOpt(const Option* aList)
+: error(false),
+#ifdef GETOPT_NO_STDIO
+  errorOutput(NULL),               // No stdio, can't print errors
+#else
+  errorOutput(GetOpt::printError), // Print error messages to stderr
+#endif
+  optionStart("-"),
+  responseFileStart(0),
+  foundFlags(NULL),
+  results(NULL),
+  suggestions(0),
+  commands(NULL),
+  errorList(NULL),
+  errorListSize(0),
+  errorCount(0),
+  conversionThreads(1),
+#ifdef GETOPT_STATS
+  stats(),
+  traceOutput(NULL),
+#endif
+  optionList(aList),
+  argc(0),
+  argi(0), chari(0), nexti(1),
+  argv(NULL),
+  order(NULL),
+  curArg(NULL),
+  normalOnly(false),
+  skipped(NULL),
+  skippedIndex(NULL),
+  skippedCount(0), skippedSize(0),
+  sourceArg(NULL),
+  sourceArgBefore(NULL),
+  sourceArgCount(0), sourceArgSize(0),
+  normalsSeen(0), firstUnseen(1),
+  longIndex(NULL),
+  storage(NULL),
+  source(NULL),
+  usedSources(NULL),
+  sourceDepth(0),
+  lineArgv(NULL),
+  lineArgvSize(0),
+  occurrence(NULL),
+  occurrenceCount(0), occurrenceSize(0),
+  grouped(NULL),
+  groupedSize(0),
+  groupEnd(NULL),
+  groupedCount(-1),
+  scanned(NULL),
+  scannedSize(0), scanEnd(-1),
+  scanning(false),
+  query(NULL),
+  positional(NULL),
+  positionalCount(-1), positionalSize(0),
+  ownIndex(NULL),
+  completed(NULL),
+  completion(NULL),
+  suggester(NULL),
+  setFound(NULL),
+  setCount(0),
+  commandTable(NULL),
+  selection(NULL),
+  selectedCount(0),
+  deferred(NULL),
+  deferredCount(0), deferredSize(0),
+  deferring(false), conversion(NULL),
+  heldError(),
+  reportAt(-1),
+  foundLog(NULL),
+  foundLogCount(-1), foundLogSize(0),
+  modules(NULL)
+{
+  compile();
+} // end GetOpt::GetOpt
+
+//--------------------------------------------------------------------
+// Constructor from prebuilt tables:
+//
+// This does no work at all on the option list.  Normally, tables is
+// GetOptTable<options>::tables, which the compiler built, or the
+// tables of a GetOpt::Schema.
+//
+// Input:
+//   tables:
+//     The lookup tables for the option list.  They are not copied,
+//     and must continue to exist as long as the GetOpt object does.
+
+GetOpt::GetOpt(const Tables& tables)
+: error(false),
+#ifdef GETOPT_NO_STDIO
+  errorOutput(NULL),               // No stdio, can't print errors
+#else
+  errorOutput(GetOpt::printError), // Print error messages to stderr
+#endif
+  optionStart("-"),
+  responseFileStart(0),
+  foundFlags(NULL),
+  results(NULL),
+  suggestions(0),
+  commands(NULL),
+  errorList(NULL),
+  errorListSize(0),
+  errorCount(0),
+  conversionThreads(1),
+#ifdef GETOPT_STATS
+  stats(),
+  traceOutput(NULL),
+#endif
+  optionList(tables.optionList),
+  argc(0),
+  argi(0), chari(0), nexti(1),
+  argv(NULL),
+  order(NULL),
+  curArg(NULL),
+  normalOnly(false),
+  returningAll(tables.returningAll),
+  skipped(NULL),
+  skippedIndex(NULL),
+  skippedCount(0), skippedSize(0),
+  sourceArg(NULL),
+  sourceArgBefore(NULL),
+  sourceArgCount(0), sourceArgSize(0),
+  normalsSeen(0), firstUnseen(1),
+  optionCount(tables.optionCount),
+  longName(tables.longName),
+  foundList(tables.foundList),
+  foundCount(tables.foundCount),
+  shortOption(tables.shortOption),
+  longIndex(tables.longIndex),
+  storage(NULL),
+  source(NULL),
+  usedSources(NULL),
+  sourceDepth(0),
+  lineArgv(NULL),
+  lineArgvSize(0),
+  occurrence(NULL),
+  occurrenceCount(0), occurrenceSize(0),
+  grouped(NULL),
+  groupedSize(0),
+  groupEnd(NULL),
+  groupedCount(-1),
+  scanned(NULL),
+  scannedSize(0), scanEnd(-1),
+  scanning(false),
+  query(NULL),
+  positional(NULL),
+  positionalCount(-1), positionalSize(0),
+  ownIndex(NULL),
+  completed(NULL),
+  completion(NULL),
+  suggester(NULL),
+  setFound(NULL),
+  setCount(0),
+  commandTable(NULL),
+  selection(NULL),
+  selectedCount(0),
+  deferred(NULL),
+  deferredCount(0), deferredSize(0),
+  deferring(false), conversion(NULL),
+  heldError(),
+  reportAt(-1),
+  foundLog(NULL),
+  foundLogCount(-1), foundLogSize(0),
+  modules(NULL)
+{
+} // end GetOpt::GetOpt
+
+//--------------------------------------------------------------------
+// Destructor:
+
+GetOpt::~GetOpt()
+{
+  closeSources();
+  delete storage;
+  delete [] skipped;
+  delete [] skippedIndex;
+  delete [] sourceArg;
+  delete [] sourceArgBefore;
+  delete [] lineArgv;
+  delete [] occurrence;
+  delete [] grouped;
+  delete [] groupEnd;
+  delete [] scanned;
+  delete [] query;
+  delete [] positional;
+  delete [] ownIndex;
+  delete [] completed;
+  delete [] completion;
+  delete suggester;
+  delete [] setFound;
+  delete commandTable;
+  delete [] selection;
+#ifndef GETOPT_NO_THREADS
+  delete [] deferred;
+#endif
+#ifndef GETOPT_NO_CHECKPOINTS
+  delete [] foundLog;
+#endif
+#ifndef GETOPT_NO_MODULES
+  delete modules;
+#endif
+} // end GetOpt::~GetOpt
+
+//--------------------------------------------------------------------
+// Standard callback function for printing error messages:
+//
+// You should generally not call this function directly.  Use
 // GetOpt::reportError to report errors, which calls the errorOutput
 // function.
 //
@@ -281,104 +5070,818 @@ void GetOpt::printError(const char* option, const char* message)
 //     This array is not copied, and must exist as long as the GetOpt
 //     object is in use.
 
-void GetOpt::init(int theArgc, const char** theArgv)
+void GetOpt::init(int theArgc, const char** theArgv)
+{
+  start(theArgc, theArgv, NULL);
+  clearFound();
+} // end GetOpt::init
+
+//--------------------------------------------------------------------
+// Prepare to process a command line without changing it:
+//
+// Input:
+//   theArgc, theArgv:
+//     As for init, but theArgv is never written to
+//   theOrder:
+//     Room for theArgc indexes (see process)
+
+void GetOpt::init(int theArgc, const char* const* theArgv, int* theOrder)
+{
+  // argv is only read when order is used:
+  start(theArgc, const_cast<const char**>(theArgv), theOrder);
+  clearFound();
+} // end GetOpt::init
+
+//--------------------------------------------------------------------
+// Reset the parsing state for a new command line:
+//
+// This is init without resetting the found flags.
+//
+// Input:
+//   theArgc, theArgv:  As for init
+//   theOrder:          As for init, or NULL to rearrange theArgv
+
+void GetOpt::start(int theArgc, const char** theArgv, int* theOrder)
+{
+  argc = theArgc;
+  argv = theArgv;
+  order = theOrder;
+  if (order)
+    for (int i = 0; i < argc; ++i)
+      order[i] = i;
+  argi = chari = 0;
+  nexti = 1;
+  skippedCount = 0;
+  sourceArgCount = normalsSeen = 0;
+  firstUnseen = 1;
+  scanning = false;
+  occurrenceCount = 0;
+  groupedCount = -1;
+  selectedCount = 0;
+  errorCount = 0;
+  error = normalOnly = false;
+  deferredCount = 0;
+  deferring  = false;
+  conversion = NULL;
+  heldError.text = NULL;
+  reportAt = -1;
+  foundLogCount = -1;
+#ifdef GETOPT_STATS
+  stats = Stats();
+#endif
+  closeSources();
+} // end GetOpt::start
+
+//--------------------------------------------------------------------
+// Set all found flags to notFound:
+
+void GetOpt::clearFound()
+{
+  if (foundFlags) {
+    for (int i = 0; i < optionCount; ++i)
+      foundFlags[i] = notFound;
+  } else {
+    for (int i = 0; i < foundCount; ++i)
+      *(foundList[i]) = notFound;
+  }
+#ifndef GETOPT_NO_MODULES
+  if (modules) modules->clearFound();
+#endif
+
+  setCount = 0;
+} // end GetOpt::clearFound
+
+//--------------------------------------------------------------------
+// Find where an option's callback should store its result:
+//
+// Normally, that's just option->data.  But if the option has the
+// inResults flag, option->data is an offset into results instead, so
+// that each GetOpt sharing an option list can store its results
+// separately.  The option list would be set up like this:
+//
+//   struct Results { int64_t  count; const char*  name; };
+//   { 'c', "count", ..., GetOpt::inResults, GetOpt::isInt64,
+//     reinterpret_cast<void*>(offsetof(Results, count)) },
+//
+// An offset of 0 is the start of results, so an option without the
+// flag still uses a NULL data member to store nothing.
+//
+// Input:
+//   option:  The option whose data is wanted
+//
+// Returns:
+//   The address the callback should use, or NULL if none (including
+//   for an inResults option when results is not set)
+
+void* GetOpt::optionData(const Option* option) const
+{
+  if (!(option->flag & GetOpt::inResults)) return option->data;
+  if (!results) return NULL;
+
+  return (static_cast<char*>(results) +
+          reinterpret_cast<size_t>(option->data));
+} // end GetOpt::optionData
+
+//--------------------------------------------------------------------
+// Build the lookup tables for an option list:
+//
+// Input:
+//   list:       The option list
+//   withIndex:  True to build the prefix tree for long options too
+//
+// Output:
+//   tables:     Points into the Storage that is returned
+//
+// Returns:
+//   The Storage that holds the tables (the caller must delete it)
+
+GetOpt::Storage* GetOpt::build(const Option* list, Tables& tables,
+                               bool withIndex)
+{
+  tables.optionList  = list;
+  tables.optionCount = countOptions(list);
+  tables.foundCount  = countFound(list);
+
+  Storage*  storage = new Storage;
+  GETOPT_TRY {
+    storage->longName  = new const char*[tables.optionCount + 1];
+    storage->foundList = new Found*[tables.foundCount + 1];
+    if (withIndex)
+      storage->node = new IndexNode[indexSize(list)];
+  } GETOPT_CATCH_ALL {
+    delete storage;
+    GETOPT_RETHROW;
+  }
+
+  const int  all = fillLists(list, storage->longName, storage->foundList);
+  tables.returningAll = (all >= 0) ? list + all : NULL;
+  fillShortTable(list, storage->shortOption);
+  if (withIndex)
+    fillIndex(list, storage->node);
+
+  tables.longName    = storage->longName;
+  tables.foundList   = storage->foundList;
+  tables.shortOption = storage->shortOption;
+  tables.longIndex   = storage->node;
+
+  return storage;
+} // end GetOpt::build
+
+//--------------------------------------------------------------------
+// Build the lookup tables from optionList:
+//
+// This sets optionCount, longName, foundList, shortOption, and
+// returningAll.
+
+void GetOpt::compile()
+{
+  Tables  tables;
+  storage = build(optionList, tables, false);
+
+  optionCount  = tables.optionCount;
+  returningAll = tables.returningAll;
+  longName     = tables.longName;
+  foundList    = tables.foundList;
+  foundCount   = tables.foundCount;
+  shortOption  = tables.shortOption;
+} // end GetOpt::compile
+
+//--------------------------------------------------------------------
+// Build an index of the long options:
+//
+// After this is called, findLongOption uses a prefix tree instead of
+// scanning the whole option list.  The results are exactly the same,
+// but the time needed depends on the length of what the user typed
+// rather than the number of options.  This is worthwhile only for
+// programs with a great many long options.
+//
+// The option list must not change after the index is built.
+// A GetOpt constructed from prebuilt Tables uses the index in them
+// (if any), and this does nothing.
+
+void GetOpt::buildIndex()
+{
+  if (!longIndex && storage) {
+    storage->node = new IndexNode[indexSize(optionList)];
+    fillIndex(optionList, storage->node);
+    longIndex = storage->node;
+  }
+} // end GetOpt::buildIndex
+
+//--------------------------------------------------------------------
+// Return the prefix tree of long options:
+//
+// This is for suggestions and completion, which need the tree even
+// if findLongOption doesn't use it.  It calls buildIndex, or if this
+// GetOpt was built from Tables that didn't have an index, builds one
+// just for them.
+
+const GetOpt::IndexNode* GetOpt::prefixTree()
+{
+  buildIndex();
+  if (longIndex) return longIndex;
+
+  if (!ownIndex) {
+    ownIndex = new IndexNode[indexSize(optionList)];
+    fillIndex(optionList, ownIndex);
+  }
+  return ownIndex;
+} // end GetOpt::prefixTree
+
+//--------------------------------------------------------------------
+// Start reading arguments from a response file:
+//
+// The arguments in the file are processed as if they had been typed
+// in place of arg.  A response file may name other response files.
+//
+// The arguments that come from a response file are not copied.  They
+// stay valid until init is called again or the GetOpt is destroyed,
+// just like the ones in argv.
+//
+// Input:
+//   arg:  The argument naming the file (beginning with responseFileStart)
+//
+// Returns:
+//   true:   The file is now the current source
+//   false:  The file couldn't be read (reportError has been called)
+
+bool GetOpt::openResponseFile(const char* arg)
+{
+#ifdef GETOPT_NO_FILES
+  report(badSource, arg,
+         " cannot be read (response files are not supported)");
+  return false;
+#else
+  if (sourceDepth >= maxSourceDepth) {
+    report(badSource, arg, " is nested too deeply");
+    return false;
+  }
+
+  ResponseFile*  file = new ResponseFile;
+
+  if (!file->open(arg + 1)) {
+    delete file;
+    report(badSource, arg, " could not be read");
+    return false;
+  }
+
+  file->name = arg;
+  pushSource(file);
+
+  return true;
+#endif // GETOPT_NO_FILES
+} // end GetOpt::openResponseFile
+
+//--------------------------------------------------------------------
+// Start reading arguments from a source:
+//
+// The arguments from aSource are processed next, as if they had been
+// typed in place of the current argument.  When it runs out, we go
+// back to where we were.  This is normally called by an option's
+// callback function (for something like --args-from-stdin), or right
+// after init.
+//
+// Input:
+//   aSource:
+//     The source to read.  It must have been allocated with new.
+//     The GetOpt object deletes it after the next init (or when the
+//     GetOpt itself is destroyed).
+
+void GetOpt::pushSource(ArgSource* aSource)
+{
+  aSource->outer = source;
+  source = aSource;
+  ++sourceDepth;
+} // end GetOpt::pushSource
+
+#ifndef GETOPT_NO_FILES
+//====================================================================
+// Class GetOpt::StreamSource:
+//
+// Reads arguments from a file descriptor, a chunk at a time.  The
+// arguments are separated by a single character: NUL (as written by
+// "find -print0") or newline, normally.  Consecutive separators mean
+// an empty argument, but a separator at the very end does not.
+//
+// Only a window of the input is kept in memory, so the arguments from
+// a StreamSource do not last like those from argv or a response file.
+// An argument stays valid until the second one after it has been
+// read, which means it is valid until nextOption is called again.
+// A callback that wants to keep one (isString, for example) must
+// copy it instead.
+//
+// The window is two buffers.  When buf fills up, the unread part of
+// it moves to spare and the two swap places, so the argument returned
+// last (an option whose argument is being read) stays where it was.
+// Only a buffer that holds no returned argument is ever grown.
+//
+// Member Variables:
+//   fd:         The file descriptor (not closed by StreamSource)
+//   separator:  The character that ends each argument
+//   buf:        The buffer being read (size+1 bytes, to leave room
+//               for a NUL)
+//   spare:      The other buffer (NULL until it's needed), which may
+//               hold the last argument returned
+//   size:       The size of buf.  It grows only if one argument won't
+//               fit in it.
+//   spareSize:  The size of spare
+//   pos:        The offset in buf of the next argument
+//   fill:       The number of bytes in buf
+//   eof:        True if fd has no more to give
+//--------------------------------------------------------------------
+// Constructor:
+//
+// Input:
+//   aFd:         The file descriptor to read
+//   aSeparator:  The character that ends each argument
+//   aWindow:     The number of bytes to keep in memory
+
+GetOpt::StreamSource::StreamSource(int aFd, char aSeparator,
+                                   unsigned aWindow)
+: fd(aFd),
+  separator(aSeparator),
+  buf(NULL), spare(NULL),
+  size(aWindow > 16 ? aWindow : 16), spareSize(0),
+  pos(0), fill(0),
+  eof(false)
+{
+  buf = new char[size + 1];
+} // end GetOpt::StreamSource::StreamSource
+
+//--------------------------------------------------------------------
+// Destructor:
+
+GetOpt::StreamSource::~StreamSource()
+{
+  delete [] buf;
+  delete [] spare;
+} // end GetOpt::StreamSource::~StreamSource
+
+//--------------------------------------------------------------------
+// Read the next argument:
+//
+// Returns:
+//   The next argument (NUL-terminated in buf)
+//   NULL if there are no more (or a read failed)
+
+const char* GetOpt::StreamSource::read()
+{
+  for (;;) {
+    char*  sep = static_cast<char*>(memchr(buf + pos, separator,
+                                           fill - pos));
+
+    if (sep || (eof && pos < fill)) {
+      if (!sep) sep = buf + fill; // The last argument had no separator
+      *sep = 0;
+      const char*  arg = buf + pos;
+      pos = sep - buf + 1;
+      if (pos > fill) pos = fill;
+      return arg;
+    } // end if found an argument
+
+    if (eof) return NULL;
+
+    if (fill == size) {         // Make some room
+      if (pos) {
+        // Buf may hold the last argument, so leave it alone:
+        if (spareSize < size) {
+          delete [] spare;      // Holds nothing still in use
+          spare     = NULL;
+          spare     = new char[size + 1];
+          spareSize = size;
+        }
+        memcpy(spare, buf + pos, fill - pos);
+        char*  full = buf;
+        buf   = spare;
+        spare = full;
+        const unsigned  fullSize = size;
+        size      = spareSize;
+        spareSize = fullSize;
+        fill -= pos;
+        pos   = 0;
+      } else {
+        // One argument fills buf, and nothing was returned from it:
+        char*  bigger = new char[2 * size + 1];
+        memcpy(bigger, buf, fill);
+        delete [] buf;
+        buf   = bigger;
+        size *= 2;
+      }
+    } // end if window is full
+
+    const ssize_t  got = ::read(fd, buf + fill, size - fill);
+
+    if (got > 0)
+      fill += got;
+    else if (got == 0 || errno != EINTR) {
+      eof = true;
+      if (got < 0) {
+        failed = true;
+        return NULL;
+      }
+    }
+  } // end forever
+} // end GetOpt::StreamSource::read
+#endif // not GETOPT_NO_FILES
+
+//--------------------------------------------------------------------
+// Delete all sources, both active and used:
+
+void GetOpt::closeSources()
+{
+  ArgSource* const  lists[] = { source, usedSources };
+
+  for (int i = 0; i < 2; ++i) {
+    ArgSource*  s = lists[i];
+    while (s) {
+      ArgSource*  next = s->outer;
+      delete s;
+      s = next;
+    }
+  }
+
+  source = usedSources = NULL;
+  sourceDepth = 0;
+} // end GetOpt::closeSources
+
+//--------------------------------------------------------------------
+// Compare a long option with an option's name:
+//
+// Each '-' in what the user typed may stand for the rest of a
+// segment of the name, so --dry-r matches --dry-run and --d-r does
+// too.
+//
+// Input:
+//   u:  As for findLongOption
+//   o:  The option's longName
+//
+// Returns:
+//   0 if it doesn't match, 1 if it's an abbreviation, 2 if it's exact
+
+#ifdef GETOPT_STATS
+static int matchName(const char* u, const char* o, long& compared)
+#else
+static int matchName(const char* u, const char* o)
+#endif
+{
+  bool partial = false;
+
+  for (;;) {
+    GETOPT_COUNT(++compared);
+    if (!*u || *u == '=') {     // Reached end of user entry
+      return (*o || partial) ? 1 : 2;
+    } else if (!*o) {
+      return 0;                 // Not a match
+    } else if (*u == *o) {
+      ++u; ++o;
+    } else if (*u == '-') {
+      partial = true;
+      while (*(++o))
+        if (*o == '-') break;
+    } else
+      return 0;                 // Not a match
+  } // end forever
+} // end matchName
+
+#ifdef GETOPT_STATS
+// Every caller is a member function, so count in its stats:
+#define matchName(u, o) matchName(u, o, stats.charsCompared)
+#endif
+
+//--------------------------------------------------------------------
+// Determine what Option a long option refers to:
+//
+// Looks first for an exact match, then for an approximate one.
+// Uses the index built by buildIndex, if there is one.
+//
+// When a command has been chosen, its options and those of the
+// commands it's inside are searched too, and so are the options of
+// any modules (see Option modules).  An exact match in any of them
+// wins; otherwise, the option must match just one option in all of
+// them.
+//
+// Input:
+//   option:
+//     The option the user typed (without the leading "--", but with
+//     any trailing argument attached by an '=')
+//
+// Returns:
+//   A pointer to the corresponding GetOpt::Option
+//   NULL if no option matched
+//   If more than one option might match, calls reportError and then
+//   returns NULL.
+
+const GetOpt::Option* GetOpt::findLongOption(const char* option)
+{
+  Tables  global;
+
+  global.optionList  = optionList;
+  global.optionCount = optionCount;
+  global.longName    = longName;
+  global.longIndex   = longIndex;
+
+  const Option*  found = NULL;
+  bool  ambiguous = false;
+
+  GETOPT_COUNT(++stats.longLookups);
+
+  // Innermost command first, and the global options last (-1):
+  for (int level = selectedCount - 1; level >= -1; --level) {
+    bool  ambiguousHere;
+    const Option*  here = findLong((level >= 0) ? commandTables(level)
+                                   : global, option, ambiguousHere);
+
+    if (here && matchName(option, here->longName) == 2)
+      return here;              // Exact match!
+    if (ambiguousHere || (here && found)) ambiguous = true;
+    if (here) found = here;
+  } // end for each option list
+
+#ifndef GETOPT_NO_MODULES
+  if (modules) {
+    bool  ambiguousHere;
+    const Option*  here = findModuleOption(option, ambiguousHere);
+
+    if (here && matchName(option, here->longName) == 2)
+      return here;              // Exact match!
+    if (ambiguousHere || (here && found)) ambiguous = true;
+    if (here) found = here;
+  } // end if there are modules
+#endif
+
+  if (ambiguous) {
+    report(ambiguousOption, curArg, " is ambiguous");
+    if (errorList && errorCount <= errorListSize) {
+      ErrorRecord&  e = errorList[errorCount - 1];
+      e.candidateCount = ambiguousMatches(option, e.candidate,
+                                          ErrorRecord::maxCandidates);
+    }
+    return NULL;
+  }
+
+  return found;
+} // end GetOpt::findLongOption
+
+//--------------------------------------------------------------------
+// Find the options that an ambiguous long option might mean:
+//
+// This is findLongOption done the slow way, to be used only after it
+// has failed.
+//
+// Input:
+//   option:  As for findLongOption
+//   max:     The most options to return
+//
+// Output:
+//   list:    The options, innermost command first.  Must have room
+//            for max.
+//
+// Returns:
+//   The number of options that might match (which may be more than
+//   max)
+
+int GetOpt::ambiguousMatches(const char* option, const Option** list,
+                             int max)
+{
+  int  count = 0;
+
+  GETOPT_COUNT(++stats.ambiguityChecks);
+
+  for (int level = selectedCount - 1; level >= -1; --level) {
+    const int  n = (level >= 0) ? commandTables(level).optionCount
+                                : optionCount;
+    const char* const* const  name = (level >= 0)
+      ? commandTables(level).longName : longName;
+    const Option* const  first = (level >= 0)
+      ? commandTables(level).optionList : optionList;
+
+    for (int i = 0; i < n; ++i)
+      if (name[i] && matchName(option, name[i])) {
+        if (count < max) list[count] = first + i;
+        ++count;
+      }
+  } // end for each option list
+
+#ifndef GETOPT_NO_MODULES
+  if (modules)
+    for (int s = 0; s < modules->slotCount; ++s) {
+      const Option* const  o = modules->option[s];
+      if (o && o->longName && *o->longName &&
+          matchName(option, o->longName)) {
+        if (count < max) list[count] = o;
+        ++count;
+      }
+    } // end for each module option
+#endif
+
+  return count;
+} // end GetOpt::ambiguousMatches
+
+//--------------------------------------------------------------------
+// Look up a long option in one option list:
+//
+// Input:
+//   tables:
+//     The tables for the list (only optionList, optionCount,
+//     longName, and longIndex are used)
+//   option:
+//     As for findLongOption
+//
+// Output:
+//   ambiguous:
+//     true if more than one option might match
+//
+// Returns:
+//   A pointer to the corresponding GetOpt::Option
+//   NULL if no option matched, or more than one might have
+
+const GetOpt::Option* GetOpt::findLong(const Tables& tables,
+                                       const char* option, bool& ambiguous)
+{
+  if (tables.longIndex) {
+    const LongIndex  tree(tables.longIndex);
+    int   index = tree.find(option, ambiguous);
+
+#ifdef GETOPT_STATS
+    stats.optionsScanned  += tree.scanned;
+    stats.charsCompared   += tree.compared;
+    stats.ambiguityChecks += tree.searched;
+#endif
+
+    return (index >= 0) ? tables.optionList + index : NULL;
+  } // end if using index
+
+  const Option*  possibleMatch = NULL;
+  ambiguous = false;
+
+  for (int i = 0; i < tables.optionCount; ++i) {
+    if (tables.longName[i]) {
+      GETOPT_COUNT(++stats.optionsScanned);
+      const int  match = matchName(option, tables.longName[i]);
+
+      if (match == 2)
+        return tables.optionList + i; // Exact match!
+      if (match) {
+        if (possibleMatch) ambiguous = true; // 2 possible matches
+        possibleMatch = tables.optionList + i;
+      }
+    } // end if option has a longName
+  } // end for each option
+
+  // We didn't find an exact match, what about a possible one?
+  GETOPT_COUNT(++stats.ambiguityChecks);
+  return ambiguous ? NULL : possibleMatch;
+} // end GetOpt::findLong
+
+//--------------------------------------------------------------------
+// Find the long options closest to an unrecognized one:
+//
+// The options returned are the ones whose names can be turned into
+// the user's text with the fewest characters inserted, deleted or
+// changed (see Suggester).  Names that would need more than about a
+// third of the text changed (and never more than 3 characters)
+// aren't suggested.  The first call builds the index of long
+// options if there isn't one (see buildIndex).
+//
+// Input:
+//   option:  The option the user typed (without the leading "--",
+//            but with any trailing argument attached by an '=')
+//   max:     The most options to return
+//
+// Output:
+//   list:    The options, closest first.  Must have room for max.
+//
+// Returns:
+//   The number of options in list
+
+int GetOpt::suggest(const char* option, const Option** list, int max)
 {
-  argc = theArgc;
-  argv = theArgv;
-  argi = chari = 0;
-  error = normalOnly = false;
+  if (max <= 0) return 0;
 
-  const Option* op = optionList;
+  if (!suggester) startSuggesting();
 
-  while (op->shortName || op->longName) {
-    if (op->found)
-      *(op->found) = notFound;
-    ++op;
+  Suggester&           sg = *suggester;
+  const char* const    equals = findChar(option, '=');
+  Suggester::Search    s;
+
+  s.text   = option;
+  s.length = int(equals ? equals - option : textLength(option));
+  s.limit  = (s.length + 2) / 3;
+  if (s.limit > 3) s.limit = 3;
+  s.list   = list;
+  s.count  = 0;
+  s.max    = max;
+
+  if (s.length > sg.maxLength + s.limit)
+    return 0;                   // Too long to be close to anything
+
+  const int  rowSize = (sg.maxLength + 1) * (s.length + 1);
+  if (sg.rowSize < rowSize) {
+    delete [] sg.row;
+    sg.row = new int[rowSize];
+    sg.rowSize = rowSize;
+  }
+  if (sg.bestSize < max) {
+    delete [] sg.best;
+    sg.best = new int[max];
+    sg.bestSize = max;
+  }
+  if (!sg.next)
+    sg.next = new int[sg.maxLength + 1];
+
+  for (int j = 0; j <= s.length; ++j)
+    sg.row[j] = j;              // Distance from the empty name
+
+  // Try the closest distances first.  A small limit cuts off almost
+  // every subtree, and as soon as one finds max options, nothing
+  // farther away could be among them:
+  const int  maxLimit = s.limit;
+  for (int limit = 0;; ++limit) {
+    s.limit = limit;
+    s.count = 0;
+    sg.search(s, optionList);
+    if (s.count == max || limit == maxLimit) break;
   }
-} // end GetOpt::init
+
+  return s.count;
+} // end GetOpt::suggest
 
 //--------------------------------------------------------------------
-// Set the returningAll member variable:
+// Create the suggester:
 
-void GetOpt::checkReturnAll()
+void GetOpt::startSuggesting()
 {
-  const Option* op = optionList;
-
-  while (op->shortName || op->longName) {
-    if (op->longName && !*(op->longName)) {
-      returningAll = op;
-      return;
-    }
-    ++op;
-  }
+  suggester = new Suggester;
+  suggester->node = prefixTree();
 
-  returningAll = NULL;
-} // end GetOpt::checkReturnAll
+  for (int i = 0; i < optionCount; ++i)
+    if (longName[i] && int(textLength(longName[i])) > suggester->maxLength)
+      suggester->maxLength = int(textLength(longName[i]));
+} // end GetOpt::startSuggesting
 
 //--------------------------------------------------------------------
-// Determine what Option a long option refers to:
+// Build the error message for an unrecognized long option:
 //
-// Looks first for an exact match, then for an approximate one.
+// If suggestions is not 0, this adds up to that many suggestions to
+// the message, like " is not a recognized option (did you mean
+// --verbose or --version?)".
 //
 // Input:
-//   option:
-//     The option the user typed (without the leading "--", but with
-//     any trailing argument attached by an '=')
+//   option:  As for suggest
 //
 // Returns:
-//   A pointer to the corresponding GetOpt::Option
-//   NULL if no option matched
-//   If more than one option might match, calls reportError and then
-//   returns NULL.
+//   The message (good until the next call)
 
-const GetOpt::Option* GetOpt::findLongOption(const char* option)
+const char* GetOpt::unrecognized(const char* option)
 {
-  const Option* op = optionList;
-  const Option*  possibleMatch = NULL;
-  bool  ambiguous = false;
+  static const char  plain[]  = " is not a recognized option";
+  static const char  didYou[] = " (did you mean ";
 
-  while (op->shortName || op->longName) {
-    if (op->longName) {
-      bool partial = false;
-      const char* u = option;
-      const char* o = op->longName;
-      for (;;) {
-        if (!*u || *u == '=') { // Reached end of user entry
-          if (*o || partial) {
-            if (possibleMatch) ambiguous = true; // 2 possible matches
-            possibleMatch = op;
-            break;              // Found possible match, keep going
-          } else return op;     // Exact match!
-        } else if (!*o) {
-          break;                // Not a match
-        } else if (*u == *o) {
-          ++u; ++o;
-        } else if (*u == '-') {
-          partial = true;
-          while (*(++o))
-            if (*o == '-') break;
-        } else
-          break;                // Not a match
-      } // end forever
-    } // end if option has a longName
-    ++op;
-  } // end while more options
+  if (suggestions <= 0) return plain;
 
-  // We didn't find an exact match, what about a possible one?
-  if (possibleMatch) {
-    if (ambiguous) { // More than one possible match found
-      reportError(argv[argi], " is ambiguous");
-      return NULL;
-    }
-    return possibleMatch;       // Found just one possible match
-  } // end if possibleMatch
+  if (!suggester) startSuggesting();
+  Suggester&  tree = *suggester;
 
-  return NULL;                  // Found no matches at all
-} // end GetOpt::findLongOption
+  if (tree.suggestedSize < suggestions) {
+    delete [] tree.suggested;
+    tree.suggested = new const Option*[suggestions];
+    tree.suggestedSize = suggestions;
+  }
+
+  const int  count = suggest(option, tree.suggested, suggestions);
+  if (!count) return plain;
+
+  int  length = sizeof(plain) + sizeof(didYou) + 2; // 2 for "?)"
+  for (int i = 0; i < count; ++i)
+    length += int(textLength(tree.suggested[i]->longName)) + 6; // "--" & ", "
+
+  if (tree.messageSize < length) {
+    delete [] tree.message;
+    tree.message = new char[length];
+    tree.messageSize = length;
+  }
+
+  char*  pos = tree.message;
+
+  pos = copyText(pos, plain);
+  pos = copyText(pos, didYou);
+  for (int i = 0; i < count; ++i) {
+    if (i)
+      pos = copyText(pos, (i < count - 1) ? ", " : " or ");
+    pos = copyText(pos, longOptionStart);
+    pos = copyText(pos, tree.suggested[i]->longName);
+  } // end for each suggestion
+  copyText(pos, "?)");
+
+  return tree.message;
+} // end GetOpt::unrecognized
 
 //--------------------------------------------------------------------
 // Determine what Option a short option refers to:
 //
+// The options of the chosen commands are tried first, innermost
+// first, then the global ones, and then those of the modules.
+//
 // Input:
 //   option:  The option to look for
 //
@@ -386,17 +5889,26 @@ const GetOpt::Option* GetOpt::findLongOption(const char* option)
 //   A pointer to the corresponding GetOpt::Option
 //   NULL if no option matched
 
-const GetOpt::Option* GetOpt::findShortOption(char option) const
+const GetOpt::Option* GetOpt::findShortOption(char option)
 {
-  const Option* op = optionList;
+  const unsigned char  c = static_cast<unsigned char>(option);
 
-  while (op->shortName || op->longName) {
-    if (op->shortName == option)
-      return op;
-    ++op;
+  GETOPT_COUNT(++stats.shortLookups);
+
+  for (int level = selectedCount; level-- > 0; ) {
+    GETOPT_COUNT(++stats.optionsScanned);
+    if (const Option* found = commandTables(level).shortOption[c])
+      return found;
   }
 
-  return NULL;
+  GETOPT_COUNT(++stats.optionsScanned);
+#ifndef GETOPT_NO_MODULES
+  if (!shortOption[c] && modules) {
+    GETOPT_COUNT(++stats.optionsScanned);
+    return modules->shortOption[c];
+  }
+#endif
+  return shortOption[c];
 } // end GetOpt::findShortOption
 
 //--------------------------------------------------------------------
@@ -406,6 +5918,21 @@ const GetOpt::Option* GetOpt::findShortOption(char option) const
 // Otherwise, the options (and their arguments) are moved before the
 // non-option arguments, but this function still returns all arguments.
 //
+// The non-option arguments are not shifted along every time another
+// option is found.  They are set aside in skipped as they are passed
+// over, and the options that follow them take their places.
+// restoreSkipped puts them back (after the last option) when we run
+// out of options, or when nextOption stops early.  This keeps the
+// whole permutation linear in argc.
+//
+// An argument that begins with responseFileStart is replaced by the
+// arguments in that file (see openResponseFile).  Its options are
+// returned in order.  Its non-option arguments can't be moved in with
+// the ones in argv, so unless returningAll is not NULL, they are kept
+// in sourceArg instead (see positionals).  That needs arguments that
+// last, so a source that isn't lasting may contain non-option
+// arguments only if returningAll is not NULL.
+//
 // Output:
 //   option:  Points to the option (after any option start characters)
 //   type:    The type of option found
@@ -413,66 +5940,218 @@ const GetOpt::Option* GetOpt::findShortOption(char option) const
 //     optLong:   A long option
 //     optShort:  A single-character option
 //   posArg:  The index of a possible argument for this option
-//            0 means use argi+1
+//            fromSource means the next argument from source
 //
 // Returns:
 //   true:   Found an option or normal argument to be returned
-//   false:  No more arguments (option & type are undefined in this case)
+//   false:  No more arguments (option & type are undefined in this
+//           case), or a response file couldn't be read (error is set)
 
 bool GetOpt::nextOption(const char*& option, Type& type, int& posArg)
 {
-  posArg = 0;
-
   if (chari) {
-    if (argv[argi][++chari]) {
-      option = argv[argi] + chari;
-      type = optShort;
+    if (curArg[++chari]) {
+      option = curArg + chari;
+      type   = optShort;
+      posArg = source ? fromSource : nexti;
       return true;
     }
     chari = 0; // We've reached the end of a short option bundle
   } // end if processing a short option bundle
 
-  if (++argi >= argc) return false; // No more options
+ nextSource:
+  while (source) {
+    const char*  arg = source->next();
+
+    if (!arg) {                 // This source is finished
+      ArgSource*  done = source;
+      source = done->outer;
+      done->outer = usedSources; // Keep its arguments around
+      usedSources = done;
+      --sourceDepth;
+      if (done->failed) {
+        report(badSource, done->name, " could not be read");
+        return false;
+      }
+      continue;
+    }
+
+    curArg = arg;
+    posArg = fromSource;
+
+    if (!normalOnly) {
+      if ((type = classify(arg, option)) != optArg) {
+        if (type == optShort) chari = 1;
+        return true;
+      }
+      if (responseFileStart && *arg == responseFileStart) {
+        if (!openResponseFile(arg)) return false;
+        continue;
+      }
+    } // end if still looking for options
+
+    if (!returningAll) {
+      if (!source->lasting) {
+        report(badSource, arg, " is not an option (only options may be"
+               " read from here)");
+        return false;
+      }
+      keepSourceArg(arg);       // Like a skipped argument in argv
+      continue;
+    }
 
-  const char*  arg = argv[argi];
+    option = arg;
+    type   = optArg;
+    return true;
+  } // end while reading from a source
 
   if (!normalOnly) {
-    if (*arg && strchr(optionStart, *arg)) {
-     foundOptionStart:
-      if (!strncmp(longOptionStart, arg, sizeof(longOptionStart)-1)) {
-        option = arg+2;
-        type = optLong;
+    for (int i = nexti; i < argc; ++i) {
+      const char*  arg = argAt(i);
+
+      if ((type = classify(arg, option)) != optArg ||
+          (responseFileStart && *arg == responseFileStart)) {
+        // Take the place of a skipped argument:
+        moveArg(++argi, i);
+        curArg = arg;
+        nexti = posArg = i + 1;
+
+        if (type == optArg) {   // A response file
+          if (!openResponseFile(arg)) return false;
+          goto nextSource;
+        }
+        if (type == optShort) chari = 1;
         return true;
+      } // end if arg is an option
+
+      if (choosingCommand()) {  // Take it as an option would be taken
+        moveArg(++argi, i);
+        curArg = arg;
+        nexti = i + 1;
+        if (!selectCommand(arg)) return false;
+        continue;
       }
-      if (arg[1]) {
-        chari  = 1;
-        option = arg+1;
-        type   = optShort;
+
+      if (returningAll) {       // Return all arguments in order
+        argi   = i;
+        nexti  = posArg = i + 1;
+        curArg = option = arg;
+        type   = optArg;
         return true;
       }
-    } // end if arg begins with option start character
-
-    if (!returningAll) { // Look for another option argument
-      for (int i = argi+1; i < argc; ++i) {
-        if (argv[i][0] && strchr(optionStart, argv[i][0])) {
-          // We found another option, move it before the other args:
-          posArg = i + 1;
-          arg = argv[i];
-          while (--i >= argi)
-            argv[i+1] = argv[i];
-          argv[argi] = arg;
-          goto foundOptionStart;
-        } // end if we found another option argument
-      } // end for remaining arguments
-      normalOnly = true; // There are no more option arguments
-    } // end if not returning all arguments in order
+
+      // Set this argument aside until we run out of options:
+      if (skippedCount == skippedSize)
+        growArgList(skipped, skippedIndex, skippedCount, skippedSize);
+
+      if (order)
+        skippedIndex[skippedCount++] = order[i];
+      else
+        skipped[skippedCount++] = arg;
+      if (i >= firstUnseen) ++normalsSeen;
+    } // end for remaining arguments
+
+    normalOnly = true; // There are no more option arguments
   } // end if still looking for options
 
-  option = arg;
+  restoreSkipped();
+
+  if (++argi >= argc) return false; // No more arguments
+
+  nexti  = posArg = argi + 1;
+  curArg = option = argAt(argi);
   type   = optArg;
   return true;
 } // end GetOpt::nextOption
 
+//--------------------------------------------------------------------
+// Determine whether an argument is an option:
+//
+// Input:
+//   arg:  The argument
+//
+// Output:
+//   option:  Points to the option (after any option start characters)
+//            Not changed if arg is not an option.
+//
+// Returns:
+//   optLong:   arg is a long option
+//   optShort:  arg begins a bundle of single-character options
+//   optArg:    arg is not an option
+
+GetOpt::Type GetOpt::classify(const char* arg, const char*& option) const
+{
+  if (*arg && findChar(optionStart, *arg)) {
+    if (startsWith(arg, longOptionStart)) {
+      option = arg+2;
+      return optLong;
+    }
+    if (arg[1]) {
+      option = arg+1;
+      return optShort;
+    }
+  } // end if arg begins with option start character
+
+  return optArg;                // Including a lone option start character
+} // end GetOpt::classify
+
+//--------------------------------------------------------------------
+// Find the argument that could belong to an option:
+//
+// Input:
+//   posArg:  As returned by nextOption
+//
+// Returns:
+//   The next argument, or NULL if there are no more
+
+const char* GetOpt::nextArgument(int posArg)
+{
+  if (posArg == fromSource)
+    return source->peek();
+
+  return (posArg < argc) ? argAt(posArg) : NULL;
+} // end GetOpt::nextArgument
+
+//--------------------------------------------------------------------
+// Put back the non-option arguments that nextOption set aside:
+//
+// They go right after the last option returned, which leaves argv
+// exactly as if each option had been moved ahead of them as soon as
+// it was found.
+
+void GetOpt::restoreSkipped()
+{
+  if (skippedCount) {
+    GETOPT_COUNT(stats.argsMoved += skippedCount);
+    if (order)
+      memcpy(order + argi + 1, skippedIndex,
+             skippedCount * sizeof(*skippedIndex));
+    else
+      memcpy(argv + argi + 1, skipped, skippedCount * sizeof(*skipped));
+    skippedCount = 0;
+  }
+  if (nexti > firstUnseen) firstUnseen = nexti;
+  nexti = argi + 1;
+} // end GetOpt::restoreSkipped
+
+//--------------------------------------------------------------------
+// Keep a non-option argument read from a source:
+//
+// It goes after the non-option arguments in argv that nextOption has
+// set aside so far (see positionals).
+//
+// Input:
+//   arg:  The argument (which must last until init is called again)
+
+void GetOpt::keepSourceArg(const char* arg)
+{
+  if (sourceArgCount == sourceArgSize)
+    growArgList(sourceArg, sourceArgBefore, sourceArgCount, sourceArgSize);
+
+  sourceArg[sourceArgCount]         = arg;
+  sourceArgBefore[sourceArgCount++] = normalsSeen;
+} // end GetOpt::keepSourceArg
+
 //--------------------------------------------------------------------
 // Return the next argument to process:
 //
@@ -490,11 +6169,83 @@ bool GetOpt::nextOption(const char*& option, Type& type, int& posArg)
 
 bool GetOpt::nextOption(const Option*& option, const char*& asEntered)
 {
+  Event  event;
+
+  if (findNextOption(event)) {
+    option    = event.option;
+    asEntered = event.asEntered;
+    return true;
+  }
+
+  restoreSkipped();             // Leave argv in order for the caller
+  return false;
+} // end GetOpt::nextOption
+
+//--------------------------------------------------------------------
+// Return the next argument to process, and what became of it:
+//
+// This is nextOption for a caller that consumes the options as they
+// are parsed (see GetOptRange.hpp), and so can't get an option's
+// argument from found and the callback.  An option with a callback
+// still has it called first, so the event describes an argument that
+// was already accepted.  An option that failed is never returned
+// (it either stops nextOption, or is skipped if errorList is set).
+//
+// Event Member Variables:
+//   option, asEntered:
+//     As for the other nextOption.  asEntered may point into the
+//     GetOpt, so it's good only until the next call.
+//   argument:
+//     The argument the option used (or the normal argument, for
+//     returningAll if it took it), or NULL if it didn't use one
+//   usedChars:
+//     How much of argument was used, or -1 for all of it.  (Only a
+//     callback taking part of a bundle of short options uses less.)
+//   connected:
+//     How argument was connected to the option (nextArg if it
+//     didn't use one)
+//   position:
+//     The index of the argument containing the option, as for an
+//     Occurrence (see Capturing occurrences)
+//
+// Output:
+//   event:  The option found (undefined if this returns false)
+//
+// Returns:
+//   true:   Found an option or normal argument to be returned
+//   false:  No more arguments match the option list
+
+bool GetOpt::nextOption(Event& event)
+{
+  if (findNextOption(event))
+    return true;
+
+  restoreSkipped();             // Leave argv in order for the caller
+  return false;
+} // end GetOpt::nextOption
+
+//--------------------------------------------------------------------
+// Find and process the next option:
+//
+// This does the work of the public nextOption, which just makes sure
+// that argv is back in order when we stop.  The return value is the
+// same.
+//
+// Output:
+//   event:  The option found (see nextOption)
+
+bool GetOpt::findNextOption(Event& event)
+{
+  const Option* option;
+  const char* asEntered;
   const char* arg;
   Type        type;
   int         posArg;
 
  nextArg:
+#ifdef GETOPT_STATS
+  const Stats  before = stats;
+#endif
   if (!nextOption(arg, type, posArg)) return false;
 
   if (type == optLong && !*arg) {
@@ -502,14 +6253,17 @@ bool GetOpt::nextOption(const Option*& option, const char*& asEntered)
     goto nextArg;
   } // end if "--" by itself (no more options)
 
+
+  const int  reported = errorCount;
+
   if (type == optShort) {
-    shortOptionBuf[0] = argv[argi][0];
+    shortOptionBuf[0] = curArg[0];
     shortOptionBuf[1] = *arg;
     shortOptionBuf[2] = 0;
     asEntered = shortOptionBuf;
     option = findShortOption(*arg);
   } else {
-    asEntered = argv[argi];
+    asEntered = curArg;
     if (type == optArg)
       option = returningAll;
     else
@@ -517,74 +6271,228 @@ bool GetOpt::nextOption(const Option*& option, const char*& asEntered)
   }
 
   if (!option) {
-    if ((type != optArg) && !error)
-      reportError(asEntered, " is not a recognized option");
+    if (type == optArg) return false;
+    // Unless findLongOption already did (or, printing just the first
+    // error, one was already printed):
+    if (errorList ? errorCount == reported : !error)
+      report(unknownOption, asEntered, ((type == optLong && !errorList)
+                                        ? unrecognized(arg)
+                                        : " is not a recognized option"));
+#ifdef GETOPT_STATS
+    trace(traceOption, NULL, asEntered, argi, before);
+#endif
+    if (errorList) goto nextArg; // Skip it
     return false;
   }
 
-  if (option->found && *option->found &&
-      !(option->flag & GetOpt::repeatable)) {
-    reportError(asEntered, " cannot be repeated");
-    return false;
+  Connection  connect = nextArg;
+  int   usedChars = -1;
+  int*  mayUseChars = NULL;
+
+  if ((type != optArg) && takesArgument(option)) {
+    if ((type == optShort) && curArg[chari+1]) {
+      mayUseChars = &usedChars;
+      arg = curArg + chari + 1;
+      if (*arg == '=') {
+        ++arg;
+        connect = withEquals;
+      } else
+        connect = adjacent;
+    } else if ((type == optLong) && (arg = findChar(arg, '='))) {
+      ++arg;                    // Skip over equals
+      connect = withEquals;
+    } else
+      arg = nextArgument(posArg);
+  } // end if option (not normal argument) that might take an argument
+
+  // The callback might push a new source:
+  ArgSource* const  argSource = source;
+  const int         position  = argi;
+
+  Found       found = useOption(option, asEntered, connect, arg,
+                                mayUseChars, position);
+  const bool  failed = (found == notFound);
+
+  if (failed) {
+#ifdef GETOPT_STATS
+    if (!errorList) trace(traceOption, option, asEntered, position, before);
+#endif
+    if (!errorList) return false;
+    // Skip the option, and the argument it would have taken:
+    found = ((option->flag & GetOpt::needArg) && arg) ? withArg : noArg;
+  }
+
+  if (found == withArg) {
+    if (usedChars >= 0)
+      chari += usedChars + (connect == withEquals);
+    else {
+      chari = 0;
+      if ((type != optArg) && (connect == nextArg) && arg) {
+        if (posArg == fromSource)
+          argSource->next();    // Use up the argument
+        else {
+          // Move the argument right after its option:
+          moveArg(++argi, posArg);
+          nexti = posArg + 1;
+        }
+      } // end if used next argument
+    } // end else didn't use just some of the characters in a bundle
+  } // end if option used its argument
+
+#ifdef GETOPT_STATS
+  trace(traceOption, option, asEntered, position, before);
+#endif
+  if (failed) goto nextArg;
+
+  event.option    = option;
+  event.asEntered = asEntered;
+  event.argument  = (found == withArg) ? arg : NULL;
+  event.usedChars = usedChars;
+  event.connected = (found == withArg) ? connect : nextArg;
+  event.position  = position;
+
+  return true;
+} // end GetOpt::findNextOption
+
+//--------------------------------------------------------------------
+// Record that an option was found:
+//
+// This checks whether it may be repeated, passes it its argument (if
+// it can take one), sets its found flag, and captures it.  The caller
+// is responsible for deciding what the argument is and for moving
+// past it.
+//
+// Input:
+//   option, asEntered, connected, argument, usedChars:
+//     As for an argument callback function.  argument is ignored if
+//     the option can't take one.
+//   position:
+//     The index of the argument containing the option (for capture)
+//
+// Returns:
+//   notFound:  There was an error (which has been reported)
+//   noArg:     The option didn't use argument
+//   withArg:   The option used argument
+
+GetOpt::Found GetOpt::useOption(const Option* option, const char* asEntered,
+                                Connection connected, const char* argument,
+                                int* usedChars, int position)
+{
+  Found* const  flag = ((foundFlags && isGlobal(option))
+                        ? foundFlags + (option - optionList)
+                        : option->found);
+
+  if (option->found && *flag && !(option->flag & GetOpt::repeatable)) {
+    report(repeatedOption, asEntered, " cannot be repeated", option);
+    return notFound;
   }
 
   Found  found = noArg;
 
-  if (option->function) {
-    int   usedChars = -1;
-    int*  mayUseChars = NULL;
-    Connection  connect = nextArg;
-
-    if (!posArg) posArg = argi + 1;
-
-    if (type != optArg) {
-      if ((type == optShort) && argv[argi][chari+1]) {
-        mayUseChars = &usedChars;
-        arg = argv[argi] + chari + 1;
-        if (*arg == '=') {
-          ++arg;
-          connect = withEquals;
-        } else
-          connect = adjacent;
-      } else if ((type == optLong) && (arg = strchr(arg, '='))) {
-        ++arg;                    // Skip over equals
-        connect = withEquals;
-      } else if (posArg < argc)
-        arg = argv[posArg];
-      else if (option->flag & GetOpt::needArg) {
-        reportError(asEntered, " requires an argument");
-        return false;
-      } else
-        arg = NULL;
-    } // end if option (not normal argument)
+  if (option->store == storeBool)
+    *static_cast<bool*>(optionData(option)) = true;
+
+  if (takesArgument(option)) {
+    if (!argument && (option->flag & GetOpt::needArg)) {
+      report(missingArgument, asEntered, " requires an argument", option);
+      return notFound;
+    }
+
+    const int  reported = errorCount;
+
+#ifndef GETOPT_NO_THREADS
+    if (deferring && deferrable(option, usedChars)) {
+      // The found flag waits for the callback (see finishDeferred):
+      defer(option, asEntered, connected, argument, flag);
+      if (option->flag & GetOpt::capture)
+        addOccurrence(option, argument, connected, position);
+      return withArg;
+    }
+#endif
 
-    if ((*(option->function))(this, option, asEntered, connect, arg,
-                              mayUseChars)) {
+    if (convert(option, asEntered, connected, argument, usedChars))
       found = withArg;
-      if (usedChars >= 0)
-        chari += usedChars;
-      else {
-        chari = 0;
-        if ((type != optArg) && (connect == nextArg) && arg) {
-          ++argi;
-          // If we moved the option, we need to move the argument:
-          while (--posArg >= argi)
-            argv[posArg+1] = argv[posArg];
-          argv[argi] = arg;
-        } // end if used next argument
-      } // end else didn't use just some of the characters in a bundle
-    } // end if found option
-    else if ((option->flag & GetOpt::needArg) && !error) {
-      reportError(asEntered, " requires an argument");
-      return false;
+    else if ((option->flag & GetOpt::needArg) && (errorList || !error)) {
+      if (errorCount == reported)
+        report(missingArgument, asEntered, " requires an argument",
+               option);
+      return notFound;
+    }
+  } // end if option can take an argument
+
+  if (flag) {
+    if (setFound && !*flag) {
+      if (setCount < optionCount)
+        setFound[setCount++] = flag;
+      else
+        setCount = optionCount + 1; // Lost track, reset them all
     }
-  } // end if option has function to call
+#ifndef GETOPT_NO_CHECKPOINTS
+    if (foundLogCount >= 0 && *flag != found) logFound(flag);
+#endif
+    *flag = found;
+  } // end if option has found flag
 
-  if (option->found)
-    *(option->found) = found;
+  if (option->flag & GetOpt::capture)
+    addOccurrence(option, (found == withArg) ? argument : NULL,
+                  (found == withArg) ? connected : nextArg, position);
 
-  return true;
-} // end GetOpt::nextOption
+  return found;
+} // end GetOpt::useOption
+
+//--------------------------------------------------------------------
+// Pass an option its argument:
+//
+// This calls the option's callback (or stores the argument, for a
+// typed option).  It may be called on several threads at once (see
+// Parallel conversion).
+//
+// Input:
+//   option, asEntered, connected, argument, usedChars:
+//     As for an argument callback function
+//
+// Returns:
+//   As for an argument callback function
+
+bool GetOpt::convert(const Option* option, const char* asEntered,
+                     Connection connected, const char* argument,
+                     int* usedChars)
+{
+  const int  reported = errorCount;
+  bool       converted;
+
+  if (option->store > storeBool || !option->function)
+    converted = storeArgument(option, asEntered, connected, argument,
+                              usedChars);
+  else {
+#ifdef GETOPT_STATS
+    // While converting, other threads are changing stats:
+    const Stats    before  = conversion ? Stats() : stats;
+    const int64_t  started = conversion ? 0 : clockTime();
+#endif
+    converted = (*(option->function))(this, option, asEntered, connected,
+                                      argument, usedChars);
+#ifdef GETOPT_STATS
+    if (!conversion) {          // Or Conversion::run counts it
+      ++stats.callbacks;
+      stats.callbackTime += clockTime() - started;
+      trace(traceCallback, option, asEntered, argi, before);
+    }
+#endif
+  } // end else call the callback
+
+  if (converted) return true;
+
+  // The callback reported its errors as otherError:
+  for (int i = reported; errorList && i < errorCount; ++i) {
+    const int  r = (reportAt >= 0) ? reportAt - (errorCount - i) : i;
+    if (r < 0 || r >= errorListSize) continue;
+    errorList[r].code   = invalidArgument;
+    errorList[r].option = option;
+  }
+
+  return false;
+} // end GetOpt::convert
 
 //--------------------------------------------------------------------
 // Report (and possibly print) an error:
@@ -597,7 +6505,8 @@ bool GetOpt::nextOption(const Option*& option, const char*& asEntered)
 // they encounter.  If printing error messages to stderr is not
 // appropriate for your application, then set errorOutput to a
 // suitable function, or to NULL to suppress error messages
-// altogether.
+// altogether.  If errorList is set, the error is recorded there
+// instead (see Collecting errors).
 //
 // Input:
 //   option:   The option that caused a problem
@@ -605,9 +6514,7 @@ bool GetOpt::nextOption(const Option*& option, const char*& asEntered)
 
 void GetOpt::reportError(const char* option, const char* message)
 {
-  error = true;
-  if (errorOutput)
-    (*errorOutput)(option, message);
+  report(otherError, option, message);
 } // end GetOpt::reportError
 
 //--------------------------------------------------------------------
@@ -638,8 +6545,171 @@ int GetOpt::process(int theArgc, const char** theArgv)
   const char* asEntered;
 
   init(theArgc, theArgv);
+#ifndef GETOPT_NO_THREADS
+  if (conversionThreads != 1)
+    return processDeferred();
+#endif
+  while (nextOption(option, asEntered))
+    ;
+
+  return argi;
+} // end GetOpt::process
+
+//--------------------------------------------------------------------
+// Process a command line without changing it:
+//
+// This is for an argv that can't or shouldn't be written to, such as
+// one in read-only or shared memory.  Instead of moving the options
+// ahead of the non-option arguments, this records where everything
+// would have gone: after it returns, argv[order[k]] is what argv[k]
+// would be after process(theArgc, theArgv).  So the non-option
+// arguments are argv[order[k]] for k from the returned value to
+// theArgc-1, and an option's argument is right after the option.
+//
+// Input:
+//   theArgc, theArgv:
+//     As for process, except that theArgv is never written to
+//   theOrder:
+//     Room for theArgc indexes.  This is not copied, and must exist
+//     as long as the GetOpt object is in use.
+//
+// Output:
+//   theOrder:  The order of the arguments (as above)
+//
+// Returns:
+//   The index (into theOrder) of the first argument that was not
+//   processed by GetOpt, as for process
+
+int GetOpt::process(int theArgc, const char* const* theArgv, int* theOrder)
+{
+  const Option* option;
+  const char* asEntered;
+
+  init(theArgc, theArgv, theOrder);
+#ifndef GETOPT_NO_THREADS
+  if (conversionThreads != 1)
+    return processDeferred();
+#endif
   while (nextOption(option, asEntered))
     ;
 
   return argi;
 } // end GetOpt::process
+
+//--------------------------------------------------------------------
+// Process many command lines, one per line of text:
+//
+// This is for programs that check a great many command lines against
+// the same options, such as a list of jobs to run.  Each line is
+// split into arguments the way a response file is (see
+// unquoteArgument), except that quotes do not continue past the end
+// of the line.  Blank lines are ignored.
+//
+// Each line is processed like a call to process, and then handler is
+// called to collect the results.  The found flags are reset between
+// lines, but only the ones that the previous line set, so the cost
+// of a line doesn't depend on the number of options.  (This relies
+// on nobody but GetOpt setting a found flag during the batch.)  The
+// arguments are unquoted in place, so no memory is allocated once
+// lineArgv is big enough.
+//
+// Errors are reported through errorOutput (or errorList) as usual,
+// and error is true when handler is called for a line that had one.
+// With errorList, handler can look at every error in its line.
+//
+// Unlike process, this ignores conversionThreads and the concurrent
+// flag: every callback is called right away, on this thread, in the
+// order its line gives.  (A line is rarely long enough for threads
+// to pay for themselves.)  To convert lines in parallel, give each
+// thread its own GetOpt and its own part of text.
+//
+// Input:
+//   text:
+//     The command lines, separated by newlines and ended by a NUL.
+//     This is modified: each argument is unquoted and NUL-terminated
+//     in place.  The arguments passed to handler point into it.
+//   handler:
+//     Called after each line is processed with:
+//       getopt:    This GetOpt
+//       line:      The line number in text (starting at 1)
+//       argc:      The number of elements in argv
+//       argv:      The arguments, with argv[0] NULL (as for process,
+//                  options have been moved ahead of normal arguments)
+//       firstArg:  The value process would have returned
+//       data:      The data passed to processBatch
+//     It should return true to continue with the next line, or false
+//     to stop.  The arguments are valid only until it returns.
+//   data:
+//     Passed to handler
+//
+// Returns:
+//   The number of lines that had errors
+
+int GetOpt::processBatch(char* text, LineFunc* handler, void* data)
+{
+  if (!setFound) {
+    setFound = new Found*[optionCount + 1];
+    setCount = optionCount + 1; // Make the first line reset them all
+  }
+
+  char* const  end = text + textLength(text);
+  char*  pos = text;
+  int    line = 0, errors = 0;
+
+  while (pos < end) {
+    char*  lineEnd = static_cast<char*>(memchr(pos, '\n', end - pos));
+    if (!lineEnd) lineEnd = end;
+
+    int  count = 1;
+    ++line;
+
+    // Split the line into arguments:
+    for (;;) {
+      while (pos < lineEnd && isSeparator(*pos))
+        ++pos;
+      if (pos >= lineEnd) break;
+
+      if (count + 1 >= lineArgvSize) {
+        const int     newSize = lineArgvSize ? 2 * lineArgvSize : 64;
+        const char**  newArgv = new const char*[newSize];
+        if (lineArgv)
+          memcpy(newArgv, lineArgv, count * sizeof(*lineArgv));
+        delete [] lineArgv;
+        lineArgv     = newArgv;
+        lineArgvSize = newSize;
+      } // end if lineArgv is full
+
+      lineArgv[count++] = pos;
+      unquoteArgument(pos, lineEnd);
+    } // end for each argument in line
+
+    pos = lineEnd + 1;
+
+    if (count == 1) continue;   // Blank line
+
+    lineArgv[0] = NULL;
+    lineArgv[count] = NULL;
+
+    // Reset only the found flags the last line set:
+    start(count, lineArgv, NULL);
+    if (setCount <= optionCount) {
+      for (int i = 0; i < setCount; ++i)
+        *(setFound[i]) = notFound;
+      setCount = 0;
+    } else
+      clearFound();
+
+    const Option* option;
+    const char* asEntered;
+
+    while (nextOption(option, asEntered))
+      ;
+
+    if (error) ++errors;
+
+    if (!(*handler)(this, line, count, lineArgv, argi, data))
+      break;
+  } // end while more lines
+
+  return errors;
+} // end GetOpt::processBatch
@@ -11,19 +11,182 @@
 #ifndef INCLUDED_GETOPT_HPP
 #define INCLUDED_GETOPT_HPP
 
+// The functions that build the lookup tables can be run by the
+// compiler when it supports C++14 (see GetOptTable.hpp):
+#if __cplusplus >= 201402L
+#define GETOPT_CONSTEXPR constexpr
+#else
+#define GETOPT_CONSTEXPR inline
+#endif
+
+#include <stdint.h>
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+// What to leave out (these must be the same for GetOpt.cpp and
+// everything that includes GetOpt.hpp):
+//   GETOPT_NO_STDIO:      printError and printCompletions
+//   GETOPT_NO_FILES:      Response files and StreamSource
+//   GETOPT_NO_STRTOD:     isFloat, isLong, isDouble, and binding a
+//                         double (which need strtod, strtol or the
+//                         locale)
+//   GETOPT_NO_NUMBERS:    All the numeric callbacks, and binding any
+//                         number (implies GETOPT_NO_STRTOD)
+//   GETOPT_NO_THREADS:    Parallel conversion (which needs POSIX
+//                         threads); conversionThreads is ignored
+//   GETOPT_NO_SIMD:       The SSE2 code in convertArgs (which is
+//                         used only when the compiler targets SSE2)
+//   GETOPT_NO_CHECKPOINTS: checkpoint and restore
+//   GETOPT_NO_MODULES:    addOptions and removeOptions
+//   GETOPT_FREESTANDING:  Everything that needs the C library, except
+//                         memcpy, memmove, memset and memchr (implies
+//                         GETOPT_NO_STDIO, GETOPT_NO_FILES,
+//                         GETOPT_NO_STRTOD, GETOPT_NO_THREADS,
+//                         GETOPT_NO_SIMD, GETOPT_NO_CHECKPOINTS and
+//                         GETOPT_NO_MODULES).
+//                         See "make -C bench footprint" for the size
+//                         this gives.
+//
+// What to add (this must also be the same everywhere):
+//   GETOPT_STATS:         Counting the work done while parsing (see
+//                         GetOpt::Stats).  Without it, none of the
+//                         counting code is compiled.
+#ifdef GETOPT_FREESTANDING
+#ifndef GETOPT_NO_STDIO
+#define GETOPT_NO_STDIO
+#endif
+#ifndef GETOPT_NO_FILES
+#define GETOPT_NO_FILES
+#endif
+#ifndef GETOPT_NO_STRTOD
+#define GETOPT_NO_STRTOD
+#endif
+#ifndef GETOPT_NO_THREADS
+#define GETOPT_NO_THREADS
+#endif
+#ifndef GETOPT_NO_SIMD
+#define GETOPT_NO_SIMD
+#endif
+#ifndef GETOPT_NO_CHECKPOINTS
+#define GETOPT_NO_CHECKPOINTS
+#endif
+#ifndef GETOPT_NO_MODULES
+#define GETOPT_NO_MODULES
+#endif
+#endif // GETOPT_FREESTANDING
+
+#if defined(GETOPT_NO_NUMBERS) && !defined(GETOPT_NO_STRTOD)
+#define GETOPT_NO_STRTOD
+#endif
+
 class GetOpt
 {
  public:
   struct Option;
+  class  ArgSource;
+  class  StreamSource;
+  class  Schema;
   enum Connection { nextArg, withEquals, adjacent     };
-  enum Flag       { needArg = 0x01, repeatable = 0x02 };
+  enum Flag       { needArg = 0x01, repeatable = 0x02, capture = 0x04,
+                    concurrent = 0x08, inResults = 0x10 };
   enum Found      { notFound, noArg, withArg          };
   enum Type       { optArg, optLong, optShort         };
+  enum ErrorCode  { unknownOption, ambiguousOption, repeatedOption,
+                    missingArgument, invalidArgument, unknownCommand,
+                    badSource, otherError };
+  enum Store      { storeNone, storeBool, storeInt, storeLong, storeULong,
+                    storeDouble, storeString, storeStringView, storeEnum };
+  struct EnumValue
+  {
+    const char*  name;
+    int          value;
+  }; // end GetOpt::EnumValue
+  template <class T> struct StoreFor;
+  struct Occurrence
+  {
+    const Option*  option;
+    const char*    argument;
+    Connection     connected;
+    int            position;
+  }; // end GetOpt::Occurrence
+  struct Occurrences
+  {
+    const Occurrence*  first;
+    const Occurrence*  last;
+    const Occurrence*  begin() const { return first; }
+    const Occurrence*  end()   const { return last;  }
+    int                size()  const { return int(last - first); }
+  }; // end GetOpt::Occurrences
+  struct Event
+  {
+    const Option*  option;
+    const char*    asEntered;
+    const char*    argument;
+    int            usedChars;
+    Connection     connected;
+    int            position;
+  }; // end GetOpt::Event
+  struct Checkpoint
+  {
+    int          argi, chari, nexti;
+    const char*  curArg;
+    bool         normalOnly, error;
+    int          errorCount;
+    int          skippedCount, occurrenceCount, selectedCount;
+    int          sourceArgCount, normalsSeen, firstUnseen;
+    int          foundChanges, setCount;
+  }; // end GetOpt::Checkpoint
+  struct Conflict
+  {
+    enum Kind { sameShortName, sameLongName, prefixName };
+    Kind           kind;
+    const Option*  option;
+    const Option*  existing;
+  }; // end GetOpt::Conflict
+#ifdef GETOPT_STATS
+  struct Stats
+  {
+    long     longLookups, shortLookups;
+    long     optionsScanned, charsCompared;
+    long     ambiguityChecks;
+    long     argsMoved;
+    long     callbacks;
+    int64_t  callbackTime;
+  }; // end GetOpt::Stats
+  enum TraceType  { traceOption, traceCallback };
+  struct Trace
+  {
+    TraceType      type;
+    const Option*  option;
+    const char*    asEntered;
+    int            position;
+    Stats          cost;
+  }; // end GetOpt::Trace
+#endif
+  struct ErrorRecord
+  {
+    enum { maxCandidates = 4 };
+    ErrorCode      code;
+    int            position;
+    int            offset;
+    const Option*  option;
+    const char*    text;
+    const char*    message;
+    const Option*  candidate[maxCandidates];
+    int            candidateCount;
+  }; // end GetOpt::ErrorRecord
   typedef bool (ArgFunc)(GetOpt* getopt, const Option* option,
                          const char* asEntered,
                          Connection connected, const char* argument,
                          int* usedChars);
   typedef void (ErrorFunc)(const char* option, const char* message);
+  typedef bool (LineFunc)(GetOpt* getopt, int line, int argc,
+                          const char** argv, int firstArg, void* data);
+#ifdef GETOPT_STATS
+  typedef void (TraceFunc)(GetOpt* getopt, const Trace& trace);
+#endif
 
   struct Option
   {
@@ -33,33 +196,180 @@ class GetOpt
     unsigned     flag;
     ArgFunc*     function;
     void*        data;
+    Store        store;
+    const EnumValue*  values;
   }; // end GetOpt::Option
 
+  struct IndexNode
+  {
+    int          firstChild, nextSibling;
+    int          exact, count, first;
+    char         ch;
+  }; // end GetOpt::IndexNode
+
+  struct Tables
+  {
+    const Option*         optionList;
+    int                   optionCount;
+    const Option*         returningAll;
+    const char* const*    longName;
+    Found* const*         foundList;
+    int                   foundCount;
+    const Option* const*  shortOption;
+    const IndexNode*      longIndex;
+  }; // end GetOpt::Tables
+
+  struct Command
+  {
+    const char*     name;
+    const Option*   options;
+    const Command*  commands;
+    void*           data;
+  }; // end GetOpt::Command
+
   bool           error;
   ErrorFunc*     errorOutput;
   const char*    optionStart;
+  char           responseFileStart;
+  Found*         foundFlags;
+  void*          results;
+  int            suggestions;
+  const Command* commands;
+  ErrorRecord*   errorList;
+  int            errorListSize;
+  int            errorCount;
+  int            conversionThreads;
+#ifdef GETOPT_STATS
+  Stats          stats;
+  TraceFunc*     traceOutput;
+#endif
 
  protected:
   const Option*  optionList;
   int            argc;
-  int            argi, chari;
+  int            argi, chari, nexti;
   const char**   argv;
+  int*           order;
+  const char*    curArg;
   bool           normalOnly;
   const Option*  returningAll;
   char           shortOptionBuf[3];
+  const char**   skipped;
+  int*           skippedIndex;
+  int            skippedCount, skippedSize;
+  const char**   sourceArg;
+  int*           sourceArgBefore;
+  int            sourceArgCount, sourceArgSize;
+  int            normalsSeen, firstUnseen;
+  int                   optionCount;
+  const char* const*    longName;
+  Found* const*         foundList;
+  int                   foundCount;
+  const Option* const*  shortOption;
+  const IndexNode*      longIndex;
+  struct Storage;
+  Storage*              storage;
+  struct LongIndex;
+  class ResponseFile;
+  ArgSource*            source;
+  ArgSource*            usedSources;
+  int                   sourceDepth;
+  const char**          lineArgv;
+  int                   lineArgvSize;
+  Occurrence*           occurrence;
+  int                   occurrenceCount, occurrenceSize;
+  Occurrence*           grouped;
+  int                   groupedSize;
+  int*                  groupEnd;
+  int                   groupedCount;
+  struct Scanned;
+  Scanned*              scanned;
+  int                   scannedSize, scanEnd;
+  bool                  scanning;
+  struct Query;
+  Query*                query;
+  const char**          positional;
+  int                   positionalCount, positionalSize;
+  IndexNode*            ownIndex;
+  int*                  completed;
+  const Option**        completion;
+  struct Suggester;
+  Suggester*            suggester;
+  Found**               setFound;
+  int                   setCount;
+  struct CommandTable;
+  CommandTable*         commandTable;
+  struct Selection;
+  Selection*            selection;
+  int                   selectedCount;
+  struct Deferred;
+  Deferred*             deferred;
+  int                   deferredCount, deferredSize;
+  bool                  deferring;
+  struct Conversion;
+  Conversion*           conversion;
+  ErrorRecord           heldError;
+  int                   reportAt;
+  struct FoundChange;
+  FoundChange*          foundLog;
+  int                   foundLogCount, foundLogSize;
+  struct ModuleIndex;
+  ModuleIndex*          modules;
 
  public:
   explicit GetOpt(const Option* aList);
+  explicit GetOpt(const Tables& tables);
+  ~GetOpt();
+  void  buildIndex();
   void  init(int theArgc, const char** theArgv);
+  void  init(int theArgc, const char* const* theArgv, int* theOrder);
   int   currentArg() const { return argi; };
   bool  nextOption(const Option*& option, const char*& asEntered);
+  bool  nextOption(Event& event);
   int   process(int theArgc, const char** theArgv);
+  int   process(int theArgc, const char* const* theArgv, int* theOrder);
+  int   processBatch(char* text, LineFunc* handler, void* data);
+#ifndef GETOPT_NO_MODULES
+  int   addOptions(const Option* list, Conflict* conflicts = 0, int max = 0);
+  bool  removeOptions(const Option* list);
+#endif
+#ifndef GETOPT_NO_CHECKPOINTS
+  int   checkpoint(Checkpoint& saved);
+  void  restore(const Checkpoint& saved, int theArgc, const char** theArgv);
+  void  restore(const Checkpoint& saved, int theArgc,
+                const char* const* theArgv, int* theOrder);
+#endif
+#ifndef GETOPT_NO_NUMBERS
+  int   convertArgs(int first, int64_t* values);
+#ifndef GETOPT_NO_STRTOD
+  int   convertArgs(int first, double* values);
+#endif
+#endif
+  void  pushSource(ArgSource* aSource);
   void  reportError(const char* option, const char* message);
+  int   formatError(const ErrorRecord& record, char* buffer, int size);
+  void* optionData(const Option* option) const;
+  Occurrences  occurrences() const;
+  Occurrences  occurrences(const Option* option);
+  void  scan(int theArgc, const char* const* theArgv);
+  bool  has(const Option* option);
+  const char* value(const Option* option);
+  int   positionals(const char* const*& list);
+  int   suggest(const char* option, const Option** list, int max);
+  int   complete(int theArgc, const char* const* theArgv,
+                 const Option* const*& list, const Option*& argumentOf);
+#ifndef GETOPT_NO_STDIO
+  int   printCompletions(int theArgc, const char* const* theArgv);
+#endif
+  int   commandCount() const { return selectedCount; }
+  const Command*  command() const;
+  const Command*  command(int level) const;
 
   // Standard callback functions:
 #ifndef GETOPT_NO_STDIO
   static void  printError(const char* option, const char* message);
 #endif
+#ifndef GETOPT_NO_STRTOD
   static bool  isFloat(GetOpt* getopt, const Option* option,
                        const char* asEntered,
                        Connection connected, const char* argument,
@@ -68,16 +378,589 @@ class GetOpt
                       const char* asEntered,
                       Connection connected, const char* argument,
                       int* usedChars);
+#endif
   static bool  isString(GetOpt* getopt, const Option* option,
                         const char* asEntered,
                         Connection connected, const char* argument,
                         int* usedChars);
+#ifndef GETOPT_NO_NUMBERS
+  static bool  isInt64(GetOpt* getopt, const Option* option,
+                       const char* asEntered,
+                       Connection connected, const char* argument,
+                       int* usedChars);
+  static bool  isUInt64(GetOpt* getopt, const Option* option,
+                        const char* asEntered,
+                        Connection connected, const char* argument,
+                        int* usedChars);
+#ifndef GETOPT_NO_STRTOD
+  static bool  isDouble(GetOpt* getopt, const Option* option,
+                        const char* asEntered,
+                        Connection connected, const char* argument,
+                        int* usedChars);
+#endif
+  static bool  isByteSize(GetOpt* getopt, const Option* option,
+                          const char* asEntered,
+                          Connection connected, const char* argument,
+                          int* usedChars);
+  static bool  isDuration(GetOpt* getopt, const Option* option,
+                          const char* asEntered,
+                          Connection connected, const char* argument,
+                          int* usedChars);
+#endif // not GETOPT_NO_NUMBERS
+
+  // Typed options:
+  template <class T>
+  static GETOPT_CONSTEXPR Option  bind(char shortName, const char* longName,
+                                       T& variable,
+                                       unsigned flag = StoreFor<T>::flag,
+                                       Found* found = 0);
+  template <class E>
+  static GETOPT_CONSTEXPR Option  bindEnum(char shortName,
+                                           const char* longName,
+                                           E& variable,
+                                           const EnumValue* values,
+                                           unsigned flag = needArg,
+                                           Found* found = 0);
+
+  // Table building (also used by GetOptTable):
+  static GETOPT_CONSTEXPR int  countOptions(const Option* list);
+  static GETOPT_CONSTEXPR int  countFound(const Option* list);
+  static GETOPT_CONSTEXPR int  indexSize(const Option* list);
+  static GETOPT_CONSTEXPR int  fillLists(const Option* list,
+                                         const char** longName,
+                                         Found** foundList);
+  static GETOPT_CONSTEXPR int  fillShortTable(const Option* list,
+                                              const Option** table);
+  static GETOPT_CONSTEXPR int  fillIndex(const Option* list,
+                                         IndexNode* node);
+  static GETOPT_CONSTEXPR int  findUnmatchable(const Option* list);
+  static GETOPT_CONSTEXPR int  findPrefixName(const Option* list,
+                                              const IndexNode* node);
+  static GETOPT_CONSTEXPR int  findArgWithoutFunction(const Option* list);
 
  protected:
-  void  checkReturnAll();
-  const Option*  findShortOption(char option) const;
+  static Storage*  build(const Option* list, Tables& tables,
+                         bool withIndex);
+  void  compile();
+  void  start(int theArgc, const char** theArgv, int* theOrder);
+  void  clearFound();
+  const Option*  findShortOption(char option);
   const Option*  findLongOption(const char* option);
+#ifdef GETOPT_STATS
+  const Option*  findLong(const Tables& tables, const char* option,
+                          bool& ambiguous);
+#else
+  static const Option*  findLong(const Tables& tables, const char* option,
+                                 bool& ambiguous);
+#endif
+  const IndexNode*  prefixTree();
+  void  startSuggesting();
+  const char* unrecognized(const char* option);
+  void  report(ErrorCode code, const char* option, const char* message,
+               const Option* which = 0);
+  int   ambiguousMatches(const char* option, const Option** list, int max);
   bool  nextOption(const char*& option, Type& type, int& posArg);
+  Type  classify(const char* arg, const char*& option) const;
+  const char*  nextArgument(int posArg);
+  bool  openResponseFile(const char* arg);
+  void  closeSources();
+  bool  findNextOption(Event& event);
+  Found useOption(const Option* option, const char* asEntered,
+                  Connection connected, const char* argument,
+                  int* usedChars, int position);
+  bool  convert(const Option* option, const char* asEntered,
+                Connection connected, const char* argument,
+                int* usedChars);
+  bool  deferrable(const Option* option, const int* usedChars) const;
+  void  defer(const Option* option, const char* asEntered,
+              Connection connected, const char* argument, Found* flag);
+  int   processDeferred();
+  void  convertDeferred();
+  void  holdError(const char* text, const char* message);
+  int   finishDeferred();
+#ifdef GETOPT_STATS
+  void  trace(TraceType type, const Option* option, const char* asEntered,
+              int position, const Stats& before);
+#endif
+  const Query&  resolve(const Option* option);
+  int   optionsEnd();
+  bool  isValue(int i);
+  bool  takesNext(int i);
+  const Option*  optionTakingNext(int i);
+  const char* lazyArgument(const Option* option, int i, const char* after,
+                           Connection& connected) const;
+  void  addOccurrence(const Option* option, const char* argument,
+                      Connection connected, int position);
+  bool  storeArgument(const Option* option, const char* asEntered,
+                      Connection connected, const char* argument,
+                      int* usedChars);
+  void  restoreSkipped();
+  void  keepSourceArg(const char* arg);
+#ifndef GETOPT_NO_CHECKPOINTS
+  void  logFound(Found* flag);
+  void  resume(const Checkpoint& saved, int theArgc, const char** theArgv,
+               int* theOrder);
+#endif
+#ifndef GETOPT_NO_MODULES
+  const Option*  findModuleOption(const char* option, bool& ambiguous);
+#endif
+  bool  choosingCommand() const;
+  bool  selectCommand(const char* name);
+  const Tables&  commandTables(int level) const;
+  bool  isGlobal(const Option* option) const
+  {
+    return option >= optionList && option < optionList + optionCount;
+  }
+
+  const char*  argAt(int i) const { return argv[order ? order[i] : i]; }
+  void  moveArg(int to, int from)
+  {
+    if (order)
+      order[to] = order[from];
+    else
+      argv[to] = argv[from];
+#ifdef GETOPT_STATS
+    ++stats.argsMoved;
+#endif
+  }
+
+ private:
+  GetOpt(const GetOpt&);              // Not copyable
+  GetOpt& operator=(const GetOpt&);
 }; // end GetOpt
 
+//====================================================================
+// Class GetOpt::ArgSource:
+//
+// A place that arguments come from other than argv (see
+// GetOpt::pushSource).  nextOption takes arguments from the innermost
+// source until it runs dry, then goes back to the source outside it
+// (and finally to argv).
+//
+// A derived class supplies the arguments by implementing read, which
+// returns the next argument or NULL when there are no more.  If it
+// stops because of an error, it should set failed to true first.
+//
+// Member Variables:
+//   outer:
+//     The source to continue with after this one (maintained by GetOpt)
+//   name:
+//     What to call this source in error messages
+//   failed:
+//     True if the source could not be read completely
+//   lasting:
+//     True if the arguments it returns stay valid until init is
+//     called again, as those from a response file do.  A derived
+//     class that can promise that should set it.
+//   pending:
+//     An argument that has been looked at by peek but not returned by
+//     next yet (valid only if havePending is true)
+//--------------------------------------------------------------------
+
+class GetOpt::ArgSource
+{
+ public:
+  ArgSource*   outer;
+  const char*  name;
+  bool         failed;
+  bool         lasting;
+
+  ArgSource() : outer(0), name(""), failed(false), lasting(false),
+                pending(0), havePending(false) {}
+  virtual ~ArgSource() {}
+
+  const char*  next()
+  {
+    if (!havePending) return read();
+    havePending = false;
+    return pending;
+  }
+
+  const char*  peek()
+  {
+    if (!havePending) {
+      pending = read();
+      havePending = true;
+    }
+    return pending;
+  }
+
+ protected:
+  virtual const char*  read() = 0;
+
+ private:
+  const char*  pending;
+  bool         havePending;
+
+  ArgSource(const ArgSource&);        // Not copyable
+  ArgSource& operator=(const ArgSource&);
+}; // end GetOpt::ArgSource
+
+#ifndef GETOPT_NO_FILES
+//====================================================================
+// Class GetOpt::StreamSource:
+//
+// Reads arguments from a file descriptor, such as the output of
+// "find -print0".  See GetOpt.cpp for details.
+//--------------------------------------------------------------------
+
+class GetOpt::StreamSource : public GetOpt::ArgSource
+{
+ public:
+  explicit StreamSource(int aFd, char aSeparator = 0,
+                        unsigned aWindow = 65536);
+  ~StreamSource();
+
+ protected:
+  const char*  read();
+
+ private:
+  int       fd;
+  char      separator;
+  char*     buf;
+  char*     spare;
+  unsigned  size, spareSize, pos, fill;
+  bool      eof;
+}; // end GetOpt::StreamSource
+#endif // not GETOPT_NO_FILES
+
+//====================================================================
+// Class GetOpt::Schema:
+//
+// The lookup tables for an option list, which can be shared by GetOpt
+// objects in different threads.  See GetOpt.cpp for details.
+//--------------------------------------------------------------------
+
+class GetOpt::Schema
+{
+ public:
+  explicit Schema(const Option* aList);
+  ~Schema();
+
+  const Tables&  tables() const { return theTables; }
+
+ private:
+  Tables    theTables;
+  Storage*  storage;
+
+  Schema(const Schema&);              // Not copyable
+  Schema& operator=(const Schema&);
+}; // end GetOpt::Schema
+
+//====================================================================
+// Typed options:
+//
+// GetOpt::bind builds an Option that stores its argument directly in
+// a variable, choosing how from the variable's type.  StoreFor<T>
+// says how to store a T, and which flags it gets by default; bind
+// won't compile for a type that has no StoreFor.  bindEnum takes a
+// list of names and values, ended by a NULL name.  See GetOpt.cpp
+// for details.
+//--------------------------------------------------------------------
+
+template <> struct GetOpt::StoreFor<bool>
+{ enum { store = storeBool, flag = 0 }; };
+#ifndef GETOPT_NO_NUMBERS
+template <> struct GetOpt::StoreFor<int>
+{ enum { store = storeInt, flag = needArg }; };
+template <> struct GetOpt::StoreFor<long>
+{ enum { store = storeLong, flag = needArg }; };
+template <> struct GetOpt::StoreFor<unsigned long>
+{ enum { store = storeULong, flag = needArg }; };
+#endif
+#ifndef GETOPT_NO_STRTOD
+template <> struct GetOpt::StoreFor<double>
+{ enum { store = storeDouble, flag = needArg }; };
+#endif
+template <> struct GetOpt::StoreFor<const char*>
+{ enum { store = storeString, flag = needArg }; };
+#if __cplusplus >= 201703L
+template <> struct GetOpt::StoreFor<std::string_view>
+{ enum { store = storeStringView, flag = needArg }; };
+#endif
+
+template <class T>
+GETOPT_CONSTEXPR GetOpt::Option GetOpt::bind(char shortName,
+                                             const char* longName,
+                                             T& variable, unsigned flag,
+                                             Found* found)
+{
+  Option  option = { shortName, longName, found, flag, 0, &variable,
+                     static_cast<Store>(StoreFor<T>::store), 0 };
+  return option;
+} // end GetOpt::bind
+
+template <class E>
+GETOPT_CONSTEXPR GetOpt::Option GetOpt::bindEnum(char shortName,
+                                                 const char* longName,
+                                                 E& variable,
+                                                 const EnumValue* values,
+                                                 unsigned flag,
+                                                 Found* found)
+{
+#if __cplusplus >= 201103L
+  static_assert(sizeof(E) == sizeof(int),
+                "GetOpt::bindEnum: the variable must be the size of an int");
+#endif
+  Option  option = { shortName, longName, found, flag, 0, &variable,
+                     storeEnum, values };
+  return option;
+} // end GetOpt::bindEnum
+
+//====================================================================
+// Table building functions:
+//
+// These are defined here so that GetOptTable can run them at compile
+// time.  GetOpt::compile uses the same ones at run time.
+//
+// Each takes an option list ended by an all-zero entry.
+//--------------------------------------------------------------------
+// Count the options (not counting the entry that ends the list):
+
+GETOPT_CONSTEXPR int GetOpt::countOptions(const Option* list)
+{
+  int  count = 0;
+
+  while (list[count].shortName || list[count].longName)
+    ++count;
+
+  return count;
+} // end GetOpt::countOptions
+
+//--------------------------------------------------------------------
+// Count the options that have a found pointer:
+
+GETOPT_CONSTEXPR int GetOpt::countFound(const Option* list)
+{
+  int  count = 0;
+
+  for (int i = 0; list[i].shortName || list[i].longName; ++i)
+    if (list[i].found) ++count;
+
+  return count;
+} // end GetOpt::countFound
+
+//--------------------------------------------------------------------
+// Count the nodes that fillIndex needs:
+//
+// That's one for each character of each long name, plus the root.
+
+GETOPT_CONSTEXPR int GetOpt::indexSize(const Option* list)
+{
+  int  size = 1;
+
+  for (int i = 0; list[i].shortName || list[i].longName; ++i)
+    if (list[i].longName)
+      for (const char* o = list[i].longName; *o; ++o)
+        ++size;
+
+  return size;
+} // end GetOpt::indexSize
+
+//--------------------------------------------------------------------
+// Fill in the long names and found pointers:
+//
+// Output:
+//   longName:   longName[i] is list[i].longName (countOptions entries)
+//   foundList:  The found pointers that are not NULL (countFound entries)
+//
+// Returns:
+//   The index of the option for normal arguments (the first one with
+//   an empty longName), or -1 if there isn't one
+
+GETOPT_CONSTEXPR int GetOpt::fillLists(const Option* list,
+                                       const char** longName,
+                                       Found** foundList)
+{
+  int  returningAll = -1;
+  int  found = 0;
+
+  for (int i = 0; list[i].shortName || list[i].longName; ++i) {
+    longName[i] = list[i].longName;
+    if (list[i].found)
+      foundList[found++] = list[i].found;
+    if (returningAll < 0 && list[i].longName && !*list[i].longName)
+      returningAll = i;
+  }
+
+  return returningAll;
+} // end GetOpt::fillLists
+
+//--------------------------------------------------------------------
+// Fill in the table of single-character options:
+//
+// Output:
+//   table:
+//     256 entries.  table[c] is the first option whose shortName is c
+//     (taken as an unsigned char), or NULL if there is none.
+//
+// Returns:
+//   The index of the first option that uses a shortName already used
+//   by an earlier one, or -1 if there are no duplicates
+
+GETOPT_CONSTEXPR int GetOpt::fillShortTable(const Option* list,
+                                            const Option** table)
+{
+  int  duplicate = -1;
+
+  for (int c = 0; c < 256; ++c)
+    table[c] = 0;
+
+  for (int i = 0; list[i].shortName || list[i].longName; ++i) {
+    const unsigned char  c = static_cast<unsigned char>(list[i].shortName);
+    if (!c) continue;
+    if (!table[c])
+      table[c] = list + i;
+    else if (duplicate < 0)
+      duplicate = i;
+  }
+
+  return duplicate;
+} // end GetOpt::fillShortTable
+
+//--------------------------------------------------------------------
+// Build the prefix tree of long names used by findLongOption:
+//
+// Each node is one character of one or more names.  The children of
+// a node are kept in a singly-linked list, so a lookup costs at most
+// one list walk per character the user typed.  Every node also knows
+// how many names end at or below it, which lets an abbreviation be
+// resolved (or found to be ambiguous) without visiting the names.
+//
+// IndexNode Member Variables:
+//   ch:           The character that leads to this node
+//   firstChild:   The index of the first child, or -1
+//   nextSibling:  The index of the next child of our parent, or -1
+//   exact:        The first option whose name ends here, or -1
+//   count:        The number of options whose names end in this subtree
+//   first:        An option whose name ends in this subtree, or -1
+//
+// Output:
+//   node:
+//     indexSize(list) entries.  node[0] is the root (the empty string).
+//
+// Returns:
+//   The index of the first option that uses a longName already used
+//   by an earlier one, or -1 if there are no duplicates
+
+GETOPT_CONSTEXPR int GetOpt::fillIndex(const Option* list, IndexNode* node)
+{
+  int  duplicate = -1;
+  int  used = 1;
+
+  node[0].firstChild = node[0].nextSibling = -1;
+  node[0].exact = node[0].first = -1;
+  node[0].count = 0;
+  node[0].ch    = 0;
+
+  for (int i = 0; list[i].shortName || list[i].longName; ++i) {
+    if (!list[i].longName) continue;
+
+    int  n = 0;
+
+    for (const char* o = list[i].longName;; ++o) {
+      ++node[n].count;
+      if (node[n].first < 0) node[n].first = i;
+      if (!*o) break;
+
+      int  c = node[n].firstChild;
+      while (c >= 0 && node[c].ch != *o)
+        c = node[c].nextSibling;
+
+      if (c < 0) {
+        c = used++;
+        node[c].firstChild = -1;
+        node[c].nextSibling = node[n].firstChild;
+        node[c].exact = node[c].first = -1;
+        node[c].count = 0;
+        node[c].ch    = *o;
+        node[n].firstChild = c;
+      }
+      n = c;
+    } // end for each character in longName
+
+    if (node[n].exact < 0)
+      node[n].exact = i;
+    else if (duplicate < 0)
+      duplicate = i;
+  } // end for each option
+
+  return duplicate;
+} // end GetOpt::fillIndex
+
+//--------------------------------------------------------------------
+// Find a long name that can never be matched:
+//
+// The user's entry ends at the first '=', so a name containing one
+// can never be typed.
+//
+// Returns:
+//   The index of the first such option, or -1 if there are none
+
+GETOPT_CONSTEXPR int GetOpt::findUnmatchable(const Option* list)
+{
+  for (int i = 0; list[i].shortName || list[i].longName; ++i)
+    if (list[i].longName)
+      for (const char* o = list[i].longName; *o; ++o)
+        if (*o == '=') return i;
+
+  return -1;
+} // end GetOpt::findUnmatchable
+
+//--------------------------------------------------------------------
+// Find a long name that can't be abbreviated:
+//
+// A name that another long name starts with can only be typed in
+// full.  Whatever part of it the user types (even using a '-' for the
+// rest of a segment) ends somewhere on the way to the longer name
+// too, so it's always ambiguous (see Conflict::prefixName).  In the
+// prefix tree, the name ends at a node that has children.  The empty
+// name (for returningAll) is skipped.
+//
+// Input:
+//   list:  The option list
+//   node:  Its prefix tree (see fillIndex)
+//
+// Returns:
+//   The index of the first such option, or -1 if there are none
+
+GETOPT_CONSTEXPR int GetOpt::findPrefixName(const Option* list,
+                                            const IndexNode* node)
+{
+  for (int i = 0; list[i].shortName || list[i].longName; ++i) {
+    if (!list[i].longName || !*list[i].longName) continue;
+
+    int  n = 0;
+    for (const char* o = list[i].longName; *o; ++o) {
+      n = node[n].firstChild;
+      while (node[n].ch != *o)
+        n = node[n].nextSibling;
+    }
+
+    if (node[n].firstChild >= 0) return i;
+  } // end for each option
+
+  return -1;
+} // end GetOpt::findPrefixName
+
+//--------------------------------------------------------------------
+// Find an option that requires an argument but has no function:
+//
+// Only the function (or a typed store, see bind, or the capture
+// flag) can take the argument, so needArg has no effect on such an
+// option.
+//
+// Returns:
+//   The index of the first such option, or -1 if there are none
+
+GETOPT_CONSTEXPR int GetOpt::findArgWithoutFunction(const Option* list)
+{
+  for (int i = 0; list[i].shortName || list[i].longName; ++i)
+    if ((list[i].flag & (needArg | capture)) == needArg &&
+        !list[i].function && list[i].store <= storeBool)
+      return i;
+
+  return -1;
+} // end GetOpt::findArgWithoutFunction
+
 #endif // INCLUDED_GETOPT_HPP
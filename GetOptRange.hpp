@@ -0,0 +1,166 @@
+//--------------------------------------------------------------------
+//   Free GetOpt 1.0
+//
+//   Copyright 2000 by Christopher J. Madsen
+//   See GetOpt.cpp for license information
+//
+//   Read the options as a range of events (requires C++20)
+//
+//--------------------------------------------------------------------
+//
+// Usage:
+//
+//   GetOpt  getopt(options);
+//
+//   for (const GetOptEvent& e : GetOptEvents(getopt, argc, argv)) {
+//     if (e.option == options + inputOption)
+//       startReading(e.argument);   // While the rest are still parsed
+//     ...
+//   }
+//
+// Each event is produced by GetOpt::nextOption(Event&) when the
+// iterator is advanced, so an option is handled before the arguments
+// after it have been looked at, and nothing is collected in between.
+// Everything that nextOption does still happens: callbacks are called,
+// found flags and bound variables are set, and errors are reported.
+// The range ends where nextOption returns false, and then
+// getopt.currentArg() is the first argument that wasn't processed.
+//
+// GetOptEvents is a single-pass input range (a std::ranges::view), so
+// it can be piped through views like std::views::filter:
+//
+//   for (const GetOptEvent& e : GetOptEvents(getopt, argc, argv)
+//                               | std::views::filter(hasArgument))
+//
+//--------------------------------------------------------------------
+
+#ifndef INCLUDED_GETOPTRANGE_HPP
+#define INCLUDED_GETOPTRANGE_HPP
+
+#if __cplusplus < 202002L
+#error GetOptRange.hpp requires C++20
+#endif
+
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <string_view>
+
+#include "GetOpt.hpp"
+
+//====================================================================
+// Class GetOptEvent:
+//
+// One option (or normal argument) found by GetOpt.  This is
+// GetOpt::Event with its strings measured.
+//
+// Member Variables:
+//   option:
+//     The option (returningAll for a normal argument)
+//   asEntered:
+//     What the user typed for the option, without the "=argument"
+//     that may follow a long option.  This may point into the GetOpt,
+//     so it's good only until the iterator is advanced.
+//   argument:
+//     The part of the argument that the option used.  Its data() is
+//     nullptr if it didn't use one (which tells that apart from an
+//     empty argument, as in --name=).
+//   connected:
+//     How argument was connected to the option
+//   position:
+//     The index in argv of the argument containing the option, as for
+//     GetOpt::currentArg
+//--------------------------------------------------------------------
+
+struct GetOptEvent
+{
+  const GetOpt::Option*  option;
+  std::string_view       asEntered;
+  std::string_view       argument;
+  GetOpt::Connection     connected;
+  int                    position;
+}; // end GetOptEvent
+
+//====================================================================
+// Class GetOptEvents:
+//
+// The events from one command line.  It doesn't own anything, so the
+// GetOpt (and argv) must outlast it.
+//--------------------------------------------------------------------
+
+class GetOptEvents : public std::ranges::view_interface<GetOptEvents>
+{
+ public:
+  class iterator
+  {
+   public:
+    typedef GetOptEvent     value_type;
+    typedef std::ptrdiff_t  difference_type;
+
+    iterator() : getopt(nullptr), event{} {}
+    explicit iterator(GetOpt* aGetopt) : getopt(aGetopt), event{} { next(); }
+
+    const GetOptEvent&  operator*() const  { return event; }
+    const GetOptEvent*  operator->() const { return &event; }
+
+    iterator&  operator++() { next(); return *this; }
+    void       operator++(int) { next(); }
+
+    bool operator==(std::default_sentinel_t) const { return !getopt; }
+
+   private:
+    GetOpt*      getopt;        // nullptr when there are no more
+    GetOptEvent  event;
+
+    void  next()
+    {
+      GetOpt::Event  e;
+
+      if (!getopt->nextOption(e)) {
+        getopt = nullptr;
+        return;
+      }
+
+      std::string_view  asEntered(e.asEntered);
+      if (e.connected == GetOpt::withEquals) {
+        const std::size_t  equals = asEntered.find('=');
+        if (equals != std::string_view::npos)
+          asEntered = asEntered.substr(0, equals);
+      }
+
+      event.option    = e.option;
+      event.asEntered = asEntered;
+      event.argument  = (!e.argument ? std::string_view()
+                         : (e.usedChars >= 0)
+                         ? std::string_view(e.argument, e.usedChars)
+                         : std::string_view(e.argument));
+      event.connected = e.connected;
+      event.position  = e.position;
+    } // end next
+  }; // end GetOptEvents::iterator
+
+  // Read the command line already passed to getopt.init:
+  explicit GetOptEvents(GetOpt& aGetopt) : getopt(&aGetopt) {}
+
+  // Read a new command line:
+  GetOptEvents(GetOpt& aGetopt, int argc, const char** argv)
+  : getopt(&aGetopt)
+  {
+    aGetopt.init(argc, argv);
+  }
+
+  GetOptEvents(GetOpt& aGetopt, int argc, const char* const* argv,
+               int* order)
+  : getopt(&aGetopt)
+  {
+    aGetopt.init(argc, argv, order);
+  }
+
+  iterator                 begin() const { return iterator(getopt); }
+  std::default_sentinel_t  end() const   { return std::default_sentinel; }
+
+ private:
+  GetOpt*  getopt;
+}; // end GetOptEvents
+
+#endif // INCLUDED_GETOPTRANGE_HPP
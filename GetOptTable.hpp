@@ -0,0 +1,145 @@
+//--------------------------------------------------------------------
+//   Free GetOpt 1.0
+//
+//   Copyright 2000 by Christopher J. Madsen
+//   See GetOpt.cpp for license information
+//
+//   Build GetOpt lookup tables at compile time (requires C++17)
+//
+//--------------------------------------------------------------------
+//
+// Usage:
+//
+//   static GetOpt::Found  verbose;
+//   static constexpr GetOpt::Option  options[] = {
+//     { 'v', "verbose", &verbose, GetOpt::repeatable, NULL, NULL },
+//     ...
+//     { 0 }
+//   };
+//
+//   GetOpt  getopt(GetOptTable<options>::tables);
+//
+// The option list must be constexpr (which means that anything it
+// points to must have static storage duration).  Using GetOptTable
+// on it checks it for mistakes with static_assert (including a long
+// name that every abbreviation of is ambiguous, because another name
+// starts with it, like --color and --color-scheme), and the compiler
+// builds everything that the GetOpt constructor would otherwise build
+// at run time, including the prefix tree used for long options.
+//
+// The lookups can also be done at compile time:
+//
+//   static_assert(GetOptTable<options>::findShort('v') == options);
+//
+//--------------------------------------------------------------------
+
+#ifndef INCLUDED_GETOPTTABLE_HPP
+#define INCLUDED_GETOPTTABLE_HPP
+
+#if __cplusplus < 201703L
+#error GetOptTable.hpp requires C++17
+#endif
+
+#include "GetOpt.hpp"
+
+//====================================================================
+// Class GetOptTableData:
+//
+// The tables for one option list.  This is separate from GetOptTable
+// only because a class can't use its own constexpr constructor in
+// the initializers of its static members.
+//--------------------------------------------------------------------
+
+template <const auto& List>
+struct GetOptTableData
+{
+  static constexpr int  optionCount = GetOpt::countOptions(List);
+  static constexpr int  foundCount  = GetOpt::countFound(List);
+  static constexpr int  nodeCount   = GetOpt::indexSize(List);
+
+  const GetOpt::Option*  shortOption[256];
+  const char*            longName[optionCount + 1];
+  GetOpt::Found*         foundList[foundCount + 1];
+  GetOpt::IndexNode      node[nodeCount];
+  int                    returningAll;
+  int                    duplicateShort;
+  int                    duplicateLong;
+
+  constexpr GetOptTableData()
+  : shortOption{}, longName{}, foundList{}, node{},
+    returningAll(-1), duplicateShort(-1), duplicateLong(-1)
+  {
+    returningAll   = GetOpt::fillLists(List, longName, foundList);
+    duplicateShort = GetOpt::fillShortTable(List, shortOption);
+    duplicateLong  = GetOpt::fillIndex(List, node);
+  }
+}; // end GetOptTableData
+
+//====================================================================
+// Class GetOptTable:
+//
+// Template Parameters:
+//   List:
+//     A constexpr array of GetOpt::Option, ended by an all-zero entry
+//
+// Static Members:
+//   tables:
+//     The lookup tables, for passing to the GetOpt constructor
+//   findShort, findLong:
+//     Look up an option by name.  These are the same as
+//     GetOpt::findShortOption and GetOpt::findLongOption, except that
+//     findLong accepts only an exact match.
+//--------------------------------------------------------------------
+
+template <const auto& List>
+class GetOptTable
+{
+  typedef GetOptTableData<List>  Data;
+
+  static constexpr Data  data{};
+
+  static_assert(data.duplicateShort < 0,
+                "GetOptTable: two options have the same shortName");
+  static_assert(data.duplicateLong < 0,
+                "GetOptTable: two options have the same longName");
+  static_assert(GetOpt::findUnmatchable(List) < 0,
+                "GetOptTable: a longName containing '=' can never match");
+  static_assert(GetOpt::findPrefixName(List, data.node) < 0,
+                "GetOptTable: a longName is the start of another one,"
+                " so it can't be abbreviated");
+  static_assert(GetOpt::findArgWithoutFunction(List) < 0,
+                "GetOptTable: an option has needArg but no function");
+
+ public:
+  static constexpr GetOpt::Tables  tables = {
+    List,
+    Data::optionCount,
+    (data.returningAll >= 0) ? List + data.returningAll : nullptr,
+    data.longName,
+    data.foundList,
+    Data::foundCount,
+    data.shortOption,
+    data.node
+  };
+
+  static constexpr const GetOpt::Option* findShort(char option)
+  {
+    return data.shortOption[static_cast<unsigned char>(option)];
+  }
+
+  static constexpr const GetOpt::Option* findLong(const char* option)
+  {
+    int  n = 0;
+
+    for (; *option && n >= 0; ++option) {
+      n = data.node[n].firstChild;
+      while (n >= 0 && data.node[n].ch != *option)
+        n = data.node[n].nextSibling;
+    }
+
+    return (n >= 0 && data.node[n].exact >= 0)
+      ? List + data.node[n].exact : nullptr;
+  }
+}; // end GetOptTable
+
+#endif // INCLUDED_GETOPTTABLE_HPP
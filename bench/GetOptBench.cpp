@@ -0,0 +1,1248 @@
+//--------------------------------------------------------------------
+//   Free GetOpt benchmarks
+//
+//   Copyright 2000 by Christopher J. Madsen
+//   See GetOpt.cpp for license information
+//
+//   Time GetOpt on large option lists and command lines
+//
+//--------------------------------------------------------------------
+//
+// Build and run with "make -C bench run".  Each test prints the time
+// per argument (or per lookup) and the number of memory allocations,
+// for sizes from small to very large.  Where the time should not grow
+// with the size, the program checks that it doesn't, and exits with
+// status 1 if the largest size is more than 4 times slower than the
+// smallest.
+//
+// On systems with glibc, the same command lines are also timed with
+// getopt_long for comparison.
+//
+// Built with GETOPT_STATS ("make -C bench stats"), the process test
+// also prints the work GetOpt counted per argument (see
+// Instrumentation in GetOpt.cpp).  The times are then slower, mostly
+// from reading the clock around every callback.
+//
+//--------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <new>
+
+#ifdef __GLIBC__
+#include <getopt.h>
+#endif
+
+#include "../GetOpt.hpp"
+
+static int  status = 0;         // The exit status
+
+//====================================================================
+// Counting allocations:
+//
+// Every allocation made with new goes through these, so a test can
+// find out how many it made.
+//--------------------------------------------------------------------
+
+static long  allocations = 0;
+
+#if __cplusplus >= 201103L
+#define THROWS_BAD_ALLOC
+#define THROWS_NOTHING  noexcept
+#else
+#define THROWS_BAD_ALLOC  throw(std::bad_alloc)
+#define THROWS_NOTHING    throw()
+#endif
+
+void* operator new(size_t size) THROWS_BAD_ALLOC
+{
+  ++allocations;
+  void*  p = malloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+void* operator new[](size_t size) THROWS_BAD_ALLOC
+{
+  return operator new(size);
+}
+
+void operator delete(void* p) THROWS_NOTHING   { free(p); }
+void operator delete[](void* p) THROWS_NOTHING { free(p); }
+#ifdef __cpp_sized_deallocation
+void operator delete(void* p, size_t) THROWS_NOTHING   { free(p); }
+void operator delete[](void* p, size_t) THROWS_NOTHING { free(p); }
+#endif
+
+//====================================================================
+// Class BenchGetOpt:
+//
+// Makes the lookup functions available to the benchmarks.
+//--------------------------------------------------------------------
+
+class BenchGetOpt : public GetOpt
+{
+ public:
+  explicit BenchGetOpt(const Option* aList) : GetOpt(aList) {}
+
+  using GetOpt::findLongOption;
+  using GetOpt::findShortOption;
+}; // end BenchGetOpt
+
+//====================================================================
+// Class OptionList:
+//
+// A generated option list of any size.
+//
+// Option i is named "<prefix>-<i>-opt" (with i in decimal, padded
+// with zeros to the width of the largest index).  The first 52 also
+// have a single-character name (a-z, then A-Z).  All of them take an
+// optional argument through GetOpt::isString.
+//
+// Member Variables:
+//   count:    The number of options
+//   option:   The list (ended by an all-zero entry)
+//   name:     The long names
+//--------------------------------------------------------------------
+
+class OptionList
+{
+ public:
+  int              count;
+  GetOpt::Option*  option;
+  char**           name;
+
+  OptionList(int aCount, const char* prefix);
+  ~OptionList();
+
+  char  shortName(int i) const
+  {
+    return (i < 26) ? 'a' + i : (i < 52) ? 'A' + i - 26 : 0;
+  }
+
+ private:
+  static const char*  value;
+
+  OptionList(const OptionList&);      // Not copyable
+  OptionList& operator=(const OptionList&);
+}; // end OptionList
+
+const char*  OptionList::value;
+
+OptionList::OptionList(int aCount, const char* prefix)
+: count(aCount),
+  option(new GetOpt::Option[aCount + 1]),
+  name(new char*[aCount])
+{
+  int  width = 1;
+  for (int n = count - 1; n >= 10; n /= 10) ++width;
+
+  for (int i = 0; i < count; ++i) {
+    name[i] = new char[strlen(prefix) + width + 8];
+    sprintf(name[i], "%s-%0*d-opt", prefix, width, i);
+
+    GetOpt::Option  o = { shortName(i), name[i], NULL, GetOpt::repeatable,
+                          GetOpt::isString, &value };
+    option[i] = o;
+  }
+
+  const GetOpt::Option  end = { 0, NULL, NULL, 0, NULL, NULL };
+  option[count] = end;
+} // end OptionList::OptionList
+
+OptionList::~OptionList()
+{
+  for (int i = 0; i < count; ++i)
+    delete [] name[i];
+  delete [] name;
+  delete [] option;
+} // end OptionList::~OptionList
+
+//====================================================================
+// Timing:
+//--------------------------------------------------------------------
+// Time a function:
+//
+// Input:
+//   func:  The function to time.  It is called repeatedly with data
+//          until at least a tenth of a second has passed.
+//   data:  Passed to func
+//   items: The number of items func handles per call
+//
+// Output:
+//   allocs:  The number of allocations per call (rounded up)
+//
+// Returns:
+//   The time per item in nanoseconds
+
+typedef void (BenchFunc)(void* data);
+
+static double timeFunc(BenchFunc* func, void* data, double items,
+                       long& allocs)
+{
+  long     runs = 0;
+  long     before = allocations;
+  clock_t  start = clock(), elapsed;
+
+  do {
+    (*func)(data);
+    ++runs;
+    elapsed = clock() - start;
+  } while (elapsed < CLOCKS_PER_SEC / 10);
+
+  allocs = (allocations - before + runs - 1) / runs;
+
+  return (1e9 * elapsed / CLOCKS_PER_SEC) / (double(runs) * items);
+} // end timeFunc
+
+//--------------------------------------------------------------------
+// Time a function by the wall clock:
+//
+// This is timeFunc for a function that uses several threads (whose
+// times clock adds together).  It doesn't count allocations.
+//
+// Input:
+//   func, data, items:  As for timeFunc
+//
+// Returns:
+//   The time per item in nanoseconds
+
+static double wallTime()
+{
+  struct timespec  now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + 1e-9 * now.tv_nsec;
+} // end wallTime
+
+static double timeWall(BenchFunc* func, void* data, double items)
+{
+  long          runs = 0;
+  const double  start = wallTime();
+  double        elapsed;
+
+  do {
+    (*func)(data);
+    ++runs;
+    elapsed = wallTime() - start;
+  } while (elapsed < 0.1);
+
+  return 1e9 * elapsed / (double(runs) * items);
+} // end timeWall
+
+//--------------------------------------------------------------------
+// Check that a time did not grow too much:
+//
+// Input:
+//   test:   The name of the test
+//   first:  The time for the smallest size
+//   last:   The time for the largest size
+
+static void checkScaling(const char* test, double first, double last)
+{
+  if (last > 4 * first) {
+    printf("  NOT SCALABLE: %s is %.1f times slower\n", test, last / first);
+    status = 1;
+  }
+} // end checkScaling
+
+//--------------------------------------------------------------------
+// Decide whether a test that takes quadratic time can be run on a
+// bigger size:
+//
+// Input:
+//   time:     The time per argument (in nanoseconds) for argc arguments
+//   argc:     The size that was just timed
+//   nextArgc: The next size to time
+//
+// Returns:
+//   true if nextArgc arguments would take over a second per run
+
+static bool tooSlow(double time, int argc, int nextArgc)
+{
+  const double  growth = double(nextArgc) / argc;
+
+  return (time * argc * growth * growth > 1e9);
+} // end tooSlow
+
+//====================================================================
+// Looking up options:
+//
+// Each lookup type is timed by the scan that findLongOption does
+// without an index and by the prefix tree built by buildIndex.  The
+// indexed times should not depend on the number of options (except
+// for an ambiguous prefix, which has to visit every candidate).
+//--------------------------------------------------------------------
+
+struct LookupData
+{
+  BenchGetOpt*  getopt;
+  const char*   key[16];
+  int           keys;
+  bool          isShort;
+}; // end LookupData
+
+static void runLookup(void* data)
+{
+  LookupData&  d = *static_cast<LookupData*>(data);
+
+  if (d.isShort) {
+    for (int i = 0; i < d.keys; ++i)
+      d.getopt->findShortOption(*d.key[i]);
+  } else {
+    for (int i = 0; i < d.keys; ++i)
+      d.getopt->findLongOption(d.key[i]);
+  }
+} // end runLookup
+
+static void benchLookup()
+{
+  static const int  sizes[] = { 10, 100, 1000, 10000 };
+  static const int  numSizes = sizeof(sizes) / sizeof(sizes[0]);
+  static const char* const  kinds[] = {
+    "short", "exact", "abbreviation", "segments", "ambiguous", "missing"
+  };
+
+  printf("lookup: ns/lookup (scan / index)\n");
+  printf("  %-14s", "options:");
+  for (int s = 0; s < numSizes; ++s)
+    printf(" %17d", sizes[s]);
+  printf("\n");
+
+  double  first[2][6], last[2][6];
+
+  for (int k = 0; k < 6; ++k) {
+    printf("  %-14s", kinds[k]);
+
+    for (int s = 0; s < numSizes; ++s) {
+      const int   n = sizes[s];
+      OptionList  list(n, "very-long-common-prefix");
+      char        keys[16][64];
+      LookupData  d;
+
+      // Spread the keys through the list:
+      d.keys = 16;
+      d.isShort = (k == 0);
+      for (int i = 0; i < d.keys; ++i) {
+        const int  o = (i * 7919) % n;
+        const char* const  name = list.name[o];
+
+        switch (k) {
+         case 0: keys[i][0] = list.shortName(o % 52); keys[i][1] = 0;
+                 break;
+         case 1: strcpy(keys[i], name); break;
+         case 2: strcpy(keys[i], name);        // Drop "-opt"
+                 keys[i][strlen(name) - 4] = 0; break;
+         case 3: sprintf(keys[i], "v-l-c-p-%s", name + 24);
+                 break;                        // "v-l-c-p-<i>-opt"
+         case 4: strcpy(keys[i], "very-long-common-prefix-"); break;
+         case 5: strcpy(keys[i], "very-long-common-prefix-x"); break;
+        }
+        d.key[i] = keys[i];
+      } // end for each key
+
+      for (int indexed = 0; indexed < 2; ++indexed) {
+        BenchGetOpt  getopt(list.option);
+        getopt.errorOutput = NULL;
+        if (indexed) getopt.buildIndex();
+        d.getopt = &getopt;
+
+        long  allocs;
+        const double  t = timeFunc(runLookup, &d, d.keys, allocs);
+        if (!s) first[indexed][k] = t;
+        last[indexed][k] = t;
+
+        printf(indexed ? " %7.1f" : " %8.1f /", t);
+      } // end for scan and index
+    } // end for each size
+    printf("\n");
+  } // end for each kind of lookup
+
+  // Indexed lookups other than ambiguous ones must not grow:
+  for (int k = 0; k < 6; ++k)
+    if (k != 4)
+      checkScaling(kinds[k], first[1][k], last[1][k]);
+} // end benchLookup
+
+//====================================================================
+// Processing command lines:
+//
+// The command line is a repeating mix of a long option with an
+// argument, an abbreviated long option, a bundle of short options,
+// and a non-option argument.  The options are spread through the
+// option list, so every option list size does the same work.
+//--------------------------------------------------------------------
+
+struct ProcessData
+{
+  GetOpt*         getopt;
+  const char**    args;
+  const char**    argv;
+  int             argc;
+  const OptionList*  list;
+#ifdef __GLIBC__
+  struct option*  longOptions;
+  const char*     shortOptions;
+#endif
+}; // end ProcessData
+
+static void runProcess(void* data)
+{
+  ProcessData&  d = *static_cast<ProcessData*>(data);
+
+  memcpy(d.argv, d.args, d.argc * sizeof(*d.argv));
+  d.getopt->process(d.argc, d.argv);
+} // end runProcess
+
+#ifdef __GLIBC__
+static void runGetoptLong(void* data)
+{
+  ProcessData&  d = *static_cast<ProcessData*>(data);
+
+  memcpy(d.argv, d.args, d.argc * sizeof(*d.argv));
+  optind = 0;                   // Start over completely
+  opterr = 0;
+  while (getopt_long(d.argc, const_cast<char**>(d.argv), d.shortOptions,
+                     d.longOptions, NULL) != -1)
+    ;
+} // end runGetoptLong
+
+//--------------------------------------------------------------------
+// Build getopt_long's tables for an option list:
+
+static void makeGetoptTables(ProcessData& d)
+{
+  const OptionList&  list = *d.list;
+  char*  shortOptions = new char[3 * 52 + 1];
+  char*  s = shortOptions;
+
+  d.longOptions = new struct option[list.count + 1];
+  for (int i = 0; i < list.count; ++i) {
+    struct option  o = { list.name[i], optional_argument, NULL, 0 };
+    d.longOptions[i] = o;
+    if (list.shortName(i)) {
+      *s++ = list.shortName(i);
+      *s++ = ':';
+      *s++ = ':';
+    }
+  }
+  *s = 0;
+  memset(d.longOptions + list.count, 0, sizeof(*d.longOptions));
+  d.shortOptions = shortOptions;
+} // end makeGetoptTables
+#endif // __GLIBC__
+
+//--------------------------------------------------------------------
+// Build a command line:
+//
+// Input:
+//   list:   The option list to use
+//   argc:   The number of arguments (including argv[0])
+//   store:  Room for the generated strings (64 bytes per argument)
+
+static void makeArgs(const OptionList& list, const char** args, int argc,
+                     char* store)
+{
+  args[0] = "bench";
+  for (int i = 1; i < argc; ++i) {
+    char* const  a = store + 64 * i;
+    const int    o = (i % list.count) * 7919 % list.count;
+
+    switch (i % 4) {
+     case 0: sprintf(a, "--%s=value", list.name[o]); break;
+     case 1: sprintf(a, "--%s", list.name[o]);
+             a[strlen(a) - 4] = 0; break;        // Abbreviated
+     case 2: sprintf(a, "-%c%c%c", list.shortName(o % 52),
+                     list.shortName((o + 1) % 52),
+                     list.shortName((o + 2) % 52)); break;
+     case 3: sprintf(a, "file%d", i); break;
+    }
+    args[i] = a;
+  } // end for each argument
+} // end makeArgs
+
+static void benchProcess()
+{
+  static const int  sizes[] = { 10, 1000, 10000 };
+  static const int  argcs[] = { 1, 100, 10000, 1000000 };
+  static const int  numSizes = sizeof(sizes) / sizeof(sizes[0]);
+  static const int  numArgcs = sizeof(argcs) / sizeof(argcs[0]);
+
+  printf("process: ns/arg (allocations per command line)\n");
+
+  for (int s = 0; s < numSizes; ++s) {
+    OptionList  list(sizes[s], "option");
+    double      first = 0, last = 0;
+#ifdef __GLIBC__
+    bool        glibcTooSlow = false;
+#endif
+
+    printf("  %5d options:", sizes[s]);
+
+    for (int a = 0; a < numArgcs; ++a) {
+      const int  argc = argcs[a] + 1;
+      char*  store = new char[64 * argc];
+      ProcessData  d;
+
+      d.args = new const char*[argc];
+      d.argv = new const char*[argc];
+      d.argc = argc;
+      d.list = &list;
+      makeArgs(list, d.args, argc, store);
+
+      GetOpt  getopt(list.option);
+      getopt.buildIndex();
+      d.getopt = &getopt;
+
+      long  allocs;
+      last = timeFunc(runProcess, &d, argc, allocs);
+      if (a == 1) first = last; // A single argument is mostly overhead
+      printf("  %d args %.1f (%ld)", argcs[a], last, allocs);
+#ifdef GETOPT_STATS
+      const GetOpt::Stats&  st = getopt.stats; // From the last run
+      printf(" {%.1f scanned, %.1f compared, %.1f moved}",
+             double(st.optionsScanned) / argc,
+             double(st.charsCompared) / argc, double(st.argsMoved) / argc);
+#endif
+
+#ifdef __GLIBC__
+      makeGetoptTables(d);
+      // getopt_long scans its option list for every long option, and
+      // its permutation is quadratic, so don't wait for it on the
+      // biggest cases:
+      if (!glibcTooSlow) {
+        const double  t = timeFunc(runGetoptLong, &d, argc, allocs);
+        printf(" [getopt_long %.1f]", t);
+        if (a + 1 < numArgcs)
+          glibcTooSlow = tooSlow(t, argc, argcs[a + 1] + 1);
+      }
+      delete [] d.shortOptions;
+      delete [] d.longOptions;
+#endif
+
+      delete [] d.argv;
+      delete [] d.args;
+      delete [] store;
+    } // end for each command line length
+    printf("\n");
+
+    checkScaling("process", first, last);
+  } // end for each option list size
+} // end benchProcess
+
+//====================================================================
+// Long bundles of single-character options:
+//
+// Each argument is a bundle of all 52 single-character options.
+//--------------------------------------------------------------------
+
+static void benchBundles()
+{
+  OptionList  list(52, "option");
+  char        bundle[54];
+
+  for (int i = 0; i < 52; ++i) {
+    list.option[i].function = NULL;   // So the bundle isn't an argument
+    bundle[i + 1] = list.shortName(i);
+  }
+  bundle[0] = '-';
+  bundle[53] = 0;
+
+  printf("bundles: ns/option (52 options per argument)\n");
+
+  double  first = 0, last = 0;
+  for (int n = 10; n <= 100000; n *= 100) {
+    ProcessData  d;
+
+    d.args = new const char*[n + 1];
+    d.argv = new const char*[n + 1];
+    d.argc = n + 1;
+    d.args[0] = "bench";
+    for (int i = 1; i <= n; ++i) d.args[i] = bundle;
+
+    GetOpt  getopt(list.option);
+    d.getopt = &getopt;
+
+    long  allocs;
+    last = timeFunc(runProcess, &d, 52.0 * n, allocs);
+    if (!first) first = last;
+    printf("  %8d args  %8.2f ns/option  (%ld)\n", n, last, allocs);
+
+    delete [] d.argv;
+    delete [] d.args;
+  } // end for each command line length
+
+  checkScaling("bundles", first, last);
+} // end benchBundles
+
+//====================================================================
+// Option permutation:
+//
+// The command line is n non-option arguments with options mixed in,
+// the way xargs or find -exec + produce them.  Every option has to
+// be moved ahead of the non-option arguments before it, so this
+// measures the cost of the permutation in GetOpt::nextOption.  The
+// time per argument should not grow with n.
+//
+// getopt_long permutes by swapping blocks of arguments, which takes
+// time proportional to n for each option, so it is timed only while
+// that stays reasonable.
+//--------------------------------------------------------------------
+
+static void benchPermute()
+{
+  static const int  every[] = { 0, 1, 10 };
+  static GetOpt::Found  verbose, output;
+  static const char*    outputFile;
+  static const GetOpt::Option  options[] = {
+    { 'v', "verbose", &verbose, GetOpt::repeatable, NULL, NULL },
+    { 'o', "output",  &output,  GetOpt::needArg | GetOpt::repeatable,
+      GetOpt::isString, &outputFile },
+    { 0 }
+  };
+
+#ifdef __GLIBC__
+  static struct option  longOptions[] = {
+    { "verbose", no_argument,       NULL, 'v' },
+    { "output",  required_argument, NULL, 'o' },
+    { NULL, 0, NULL, 0 }
+  };
+  bool  glibcTooSlow;
+#endif
+
+  for (unsigned e = 0; e < sizeof(every) / sizeof(every[0]); ++e) {
+    double  first = 0, last = 0;
+
+    if (every[e])
+      printf("permute: an option after every %d non-options\n", every[e]);
+    else
+      printf("permute: all options at the end\n");
+
+#ifdef __GLIBC__
+    glibcTooSlow = false;
+#endif
+
+    for (int n = 1000; n <= 1000000; n *= 10) {
+      ProcessData  d;
+      int  argc = 1;
+
+      d.args = new const char*[n + 1];
+      d.argv = new const char*[n + 1];
+      d.args[0] = "bench";
+      for (int i = 0; argc < n + 1; ++i) {
+        if (every[e] ? (i % (every[e] + 1) == every[e]) : (argc >= n - 2)) {
+          d.args[argc++] = "-v";
+          if (argc < n - 1) {
+            d.args[argc++] = "-o";
+            d.args[argc++] = "out";
+          }
+        } else
+          d.args[argc++] = "file";
+      } // end for each argument
+      d.argc = argc;
+
+      GetOpt  getopt(options);
+      d.getopt = &getopt;
+
+      long  allocs;
+      last = timeFunc(runProcess, &d, argc, allocs);
+      if (!first) first = last;
+      printf("  %8d args  %8.2f ns/arg  (%ld)", n, last, allocs);
+
+#ifdef __GLIBC__
+      if (!glibcTooSlow) {
+        d.longOptions  = longOptions;
+        d.shortOptions = "vo:";
+        const double  t = timeFunc(runGetoptLong, &d, argc, allocs);
+        printf("  [getopt_long %.2f]", t);
+        glibcTooSlow = tooSlow(t, argc, 10 * argc);
+      }
+#endif
+      printf("\n");
+
+      delete [] d.argv;
+      delete [] d.args;
+    } // end for each command line length
+
+    checkScaling("permute", first, last);
+  } // end for each option spacing
+} // end benchPermute
+
+//====================================================================
+// Suggesting options:
+//
+// Each misspelling is one character changed, one dropped, or two
+// swapped.  Since the generated names differ only in their numbers,
+// a changed digit has many near neighbours, which is the hard case.
+// The first call (which builds the index) is not timed.
+//--------------------------------------------------------------------
+
+struct SuggestData
+{
+  GetOpt*       getopt;
+  const char*   key[16];
+  int           keys;
+}; // end SuggestData
+
+static void runSuggest(void* data)
+{
+  SuggestData&           d = *static_cast<SuggestData*>(data);
+  const GetOpt::Option*  list[3];
+
+  for (int i = 0; i < d.keys; ++i)
+    d.getopt->suggest(d.key[i], list, 3);
+} // end runSuggest
+
+static void benchSuggest()
+{
+  static const int  sizes[] = { 10, 100, 1000, 10000 };
+  static const int  numSizes = sizeof(sizes) / sizeof(sizes[0]);
+
+  printf("suggest: us/misspelled option (3 suggestions)\n");
+
+  for (int s = 0; s < numSizes; ++s) {
+    const int    n = sizes[s];
+    OptionList   list(n, "option");
+    char         keys[16][64];
+    SuggestData  d;
+
+    d.keys = 16;
+    for (int i = 0; i < d.keys; ++i) {
+      char* const  key = keys[i];
+      strcpy(key, list.name[(i % n) * 7919 % n]);
+
+      const int  length = int(strlen(key));
+      switch (i % 3) {
+       case 0: key[i % length] = 'x'; break;
+       case 1: memmove(key + 2, key + 3, length - 2); break;
+       case 2: { const char c = key[1]; key[1] = key[2]; key[2] = c; }
+               break;
+      }
+      d.key[i] = key;
+    } // end for each key
+
+    GetOpt  getopt(list.option);
+    d.getopt = &getopt;
+    runSuggest(&d);
+
+    long  allocs;
+    const double  t = timeFunc(runSuggest, &d, d.keys, allocs);
+
+    printf("  %6d options: %8.2f us  (%ld)\n", n, t / 1000, allocs);
+  } // end for each size
+} // end benchSuggest
+
+//====================================================================
+// Completing options:
+//
+// Each word is the start of a name, cut off before its number, in
+// the middle of it, or just before "-opt", so there are many, a few,
+// or just one completion.  The time is for a whole call to complete,
+// as made for one Tab press.
+//--------------------------------------------------------------------
+
+struct CompleteData
+{
+  GetOpt*       getopt;
+  const char*   argv[16][3];
+  int           keys;
+}; // end CompleteData
+
+static void runComplete(void* data)
+{
+  CompleteData&                d = *static_cast<CompleteData*>(data);
+  const GetOpt::Option* const* list;
+  const GetOpt::Option*        argumentOf;
+
+  for (int i = 0; i < d.keys; ++i)
+    d.getopt->complete(3, d.argv[i], list, argumentOf);
+} // end runComplete
+
+static void benchComplete()
+{
+  static const int  sizes[] = { 10, 100, 1000, 10000 };
+  static const int  numSizes = sizeof(sizes) / sizeof(sizes[0]);
+
+  printf("complete: us/word\n");
+
+  for (int s = 0; s < numSizes; ++s) {
+    const int     n = sizes[s];
+    OptionList    list(n, "option");
+    char          keys[16][64];
+    CompleteData  d;
+
+    d.keys = 16;
+    for (int i = 0; i < d.keys; ++i) {
+      const char* const  name = list.name[(i % n) * 7919 % n];
+      const int          length = int(strlen(name));
+      const int          cut[] = { 7, (7 + length - 4) / 2, length - 4 };
+
+      sprintf(keys[i], "--%.*s", cut[i % 3], name);
+      d.argv[i][0] = "bench";
+      d.argv[i][1] = "-a";
+      d.argv[i][2] = keys[i];
+    } // end for each key
+
+    GetOpt  getopt(list.option);
+    d.getopt = &getopt;
+    runComplete(&d);
+
+    long  allocs;
+    const double  t = timeFunc(runComplete, &d, d.keys, allocs);
+
+    printf("  %6d options: %8.2f us  (%ld)\n", n, t / 1000, allocs);
+  } // end for each size
+} // end benchComplete
+
+//====================================================================
+// Choosing commands:
+//
+// Each command line names one of the commands and gives one of its
+// options and one global option.  Every command has the same 100
+// options.  The first pass (which builds the table of command names
+// and each command's option tables) is not timed, so the time should
+// not depend on the number of commands.
+//--------------------------------------------------------------------
+
+struct CommandData
+{
+  GetOpt*       getopt;
+  const char*   argv[16][4];
+  int           keys;
+}; // end CommandData
+
+static void runCommand(void* data)
+{
+  CommandData&  d = *static_cast<CommandData*>(data);
+
+  for (int i = 0; i < d.keys; ++i)
+    d.getopt->process(4, d.argv[i]);
+} // end runCommand
+
+static void benchCommand()
+{
+  static const int  sizes[] = { 10, 100, 1000, 10000 };
+  static const int  numSizes = sizeof(sizes) / sizeof(sizes[0]);
+
+  printf("command: ns/command line\n");
+
+  OptionList  global(10, "global");
+  OptionList  options(100, "option");
+  double      first = 0, last = 0;
+
+  for (int s = 0; s < numSizes; ++s) {
+    const int         n = sizes[s];
+    OptionList        names(n, "command");
+    GetOpt::Command*  command = new GetOpt::Command[n + 1];
+    CommandData       d;
+
+    for (int i = 0; i < n; ++i) {
+      const GetOpt::Command  c = { names.name[i], options.option, NULL, NULL };
+      command[i] = c;
+    }
+    const GetOpt::Command  end = { NULL, NULL, NULL, NULL };
+    command[n] = end;
+
+    d.keys = 16;
+    for (int i = 0; i < d.keys; ++i) {
+      d.argv[i][0] = "bench";
+      d.argv[i][1] = names.name[(i % n) * 7919 % n];
+      d.argv[i][2] = "-a";
+      d.argv[i][3] = "-b";
+    } // end for each command line
+
+    GetOpt  getopt(global.option);
+    getopt.commands = command;
+    d.getopt = &getopt;
+    runCommand(&d);
+
+    long  allocs;
+    last = timeFunc(runCommand, &d, d.keys, allocs);
+    if (!first) first = last;
+
+    printf("  %6d commands: %8.2f ns  (%ld)\n", n, last, allocs);
+
+    delete [] command;
+  } // end for each size
+
+  checkScaling("command", first, last);
+} // end benchCommand
+
+//====================================================================
+// Converting arguments in parallel:
+//
+// Every normal argument goes through a callback that does about as
+// much work as checking a file name, with conversionThreads set to
+// 1, 2, 4, and one thread per processor (0).  There's no scaling
+// check, since the speedup depends on the machine.
+//--------------------------------------------------------------------
+
+static bool checkFile(GetOpt*, const GetOpt::Option*, const char*,
+                      GetOpt::Connection, const char* argument, int*)
+{
+  unsigned  hash = 0;
+
+  for (int i = 0; i < 50; ++i)
+    for (const char* c = argument; *c; ++c)
+      hash = hash * 31 + static_cast<unsigned char>(*c);
+
+  return (hash != 0xdeadbeef);
+} // end checkFile
+
+static void benchConvert()
+{
+  static const int  threads[] = { 1, 2, 4, 0 };
+  static const int  n = 100000;
+  static GetOpt::Found  file, verbose;
+  static const GetOpt::Option  options[] = {
+    { 0,  "",        &file,
+      GetOpt::needArg | GetOpt::repeatable | GetOpt::concurrent,
+      checkFile, NULL },
+    { 'v', "verbose", &verbose, GetOpt::repeatable, NULL, NULL },
+    { 0 }
+  };
+
+  printf("convert: ns/arg (%d arguments with a callback)\n", n);
+
+  ProcessData  d;
+
+  d.args = new const char*[n + 1];
+  d.argv = new const char*[n + 1];
+  d.args[0] = "bench";
+  for (int i = 1; i <= n; ++i)
+    d.args[i] = (i % 100) ? "src/module/file.cpp" : "-v";
+  d.argc = n + 1;
+
+  GetOpt  getopt(options);
+  d.getopt = &getopt;
+
+  for (unsigned t = 0; t < sizeof(threads) / sizeof(threads[0]); ++t) {
+    getopt.conversionThreads = threads[t];
+    printf("  %d threads: %8.2f\n", threads[t],
+           timeWall(runProcess, &d, d.argc));
+  }
+
+  delete [] d.argv;
+  delete [] d.args;
+} // end benchConvert
+
+//====================================================================
+// Converting numbers:
+//
+// A command line of numbers (after a "--", since some are negative)
+// is converted one at a time by a returningAll option (with isLong or
+// isFloat), and then all at once by convertArgs.  There's no scaling
+// check, since both are linear.
+//--------------------------------------------------------------------
+
+struct NumberData
+{
+  ProcessData  process;
+  int64_t*     ints;
+  double*      doubles;
+}; // end NumberData
+
+static void runConvertInts(void* data)
+{
+  NumberData&  d = *static_cast<NumberData*>(data);
+
+  memcpy(d.process.argv, d.process.args,
+         d.process.argc * sizeof(*d.process.argv));
+  d.process.getopt->convertArgs(d.process.getopt->process(d.process.argc,
+                                                          d.process.argv),
+                                d.ints);
+} // end runConvertInts
+
+static void runConvertDoubles(void* data)
+{
+  NumberData&  d = *static_cast<NumberData*>(data);
+
+  memcpy(d.process.argv, d.process.args,
+         d.process.argc * sizeof(*d.process.argv));
+  d.process.getopt->convertArgs(d.process.getopt->process(d.process.argc,
+                                                          d.process.argv),
+                                d.doubles);
+} // end runConvertDoubles
+
+static void benchNumbers()
+{
+  static const int  n = 500000;
+  static long    longValue;
+  static double  doubleValue;
+  static const GetOpt::Option  eachLong[] = {
+    { 0, "", NULL, GetOpt::needArg | GetOpt::repeatable,
+      GetOpt::isLong, &longValue },
+    { 0 }
+  };
+  static const GetOpt::Option  eachFloat[] = {
+    { 0, "", NULL, GetOpt::needArg | GetOpt::repeatable,
+      GetOpt::isFloat, &doubleValue },
+    { 0 }
+  };
+  static const GetOpt::Option  none[] = { { 0 } };
+
+  printf("numbers: ns/arg (%d arguments, one at a time / convertArgs)\n",
+         n);
+
+  NumberData  d;
+  char*       text = new char[n * 24];
+  const char**  ints = new const char*[n + 2];
+  const char**  doubles = new const char*[n + 2];
+  char*       p = text;
+
+  // The lengths are random, so the branch predictor can't learn them:
+  unsigned long  random = 1;
+
+  ints[0] = doubles[0] = "bench";
+  ints[1] = doubles[1] = "--";
+  for (int i = 2; i < n + 2; ++i) {
+    static const long long  scale[] = { 10, 1000, 100000, 10000000,
+                                        1000000000, 1000000000000LL };
+    random = (random * 1103515245 + 12345) & 0x7fffffff;
+    const long long  value = (random * 2654435761LL) % scale[random % 6];
+    ints[i] = p;
+    p += sprintf(p, "%lld", ((i & 1) ? -1 : 1) * value) + 1;
+    doubles[i] = p;
+    p += sprintf(p, "%.*f", int(random >> 8) % 7, double(value) / 1000) + 1;
+  }
+
+  d.process.argv = new const char*[n + 2];
+  d.process.argc = n + 2;
+  d.ints = new int64_t[n];
+  d.doubles = new double[n];
+
+  GetOpt  getLong(eachLong), getFloat(eachFloat), getAll(none);
+  long    allocs;
+
+  d.process.args = ints;
+  d.process.getopt = &getLong;
+  const double  eachInt = timeFunc(runProcess, &d.process, n, allocs);
+  d.process.getopt = &getAll;
+  printf("  integers  %8.2f / %8.2f\n", eachInt,
+         timeFunc(runConvertInts, &d, n, allocs));
+
+  d.process.args = doubles;
+  d.process.getopt = &getFloat;
+  const double  eachDouble = timeFunc(runProcess, &d.process, n, allocs);
+  d.process.getopt = &getAll;
+  printf("  doubles   %8.2f / %8.2f\n", eachDouble,
+         timeFunc(runConvertDoubles, &d, n, allocs));
+
+  delete [] d.doubles;
+  delete [] d.ints;
+  delete [] d.process.argv;
+  delete [] doubles;
+  delete [] ints;
+  delete [] text;
+} // end benchNumbers
+
+//====================================================================
+// Option modules:
+//
+// Each module is a list of 10 options added with addOptions.  A
+// lookup (exact or abbreviated) and adding and removing one more
+// module should not depend on the number of modules.
+//--------------------------------------------------------------------
+
+struct ModuleData
+{
+  LookupData           lookup;
+  const OptionList*  extra;
+}; // end ModuleData
+
+static void runAddRemove(void* data)
+{
+  ModuleData&  d = *static_cast<ModuleData*>(data);
+
+  d.lookup.getopt->addOptions(d.extra->option);
+  d.lookup.getopt->removeOptions(d.extra->option);
+} // end runAddRemove
+
+static void benchModules()
+{
+  static const int  sizes[] = { 10, 100, 1000 };
+  static const int  numSizes = sizeof(sizes) / sizeof(sizes[0]);
+
+  printf("modules: ns/lookup (exact / abbreviation), ns to add & remove one\n");
+
+  OptionList  global(10, "global");
+  double      first[3], last[3];
+
+  for (int s = 0; s < numSizes; ++s) {
+    const int     n = sizes[s];
+    OptionList**  module = new OptionList*[n + 1];
+    BenchGetOpt   getopt(global.option);
+    char          keys[2][16][64];
+    ModuleData    d;
+
+    getopt.errorOutput = NULL;
+    for (int m = 0; m <= n; ++m) {
+      char  prefix[32];
+      sprintf(prefix, "module-%04d", m);
+      module[m] = new OptionList(10, prefix);
+      for (int i = 0; i < 10; ++i)
+        module[m]->option[i].shortName = 0; // They'd all conflict
+      if (m < n && getopt.addOptions(module[m]->option)) {
+        printf("  NOT ADDED: %s\n", prefix);
+        status = 1;
+      }
+    } // end for each module
+
+    // Spread the keys through the modules:
+    d.lookup.getopt  = &getopt;
+    d.lookup.keys    = 16;
+    d.lookup.isShort = false;
+    d.extra          = module[n];
+    for (int i = 0; i < d.lookup.keys; ++i) {
+      const char* const  name = module[(i * 7919) % n]->name[i % 10];
+      strcpy(keys[0][i], name);
+      strcpy(keys[1][i], name);
+      keys[1][i][strlen(name) - 4] = 0; // Drop "-opt"
+    }
+
+    long    allocs;
+    double  t[3];
+    for (int k = 0; k < 2; ++k) {
+      for (int i = 0; i < d.lookup.keys; ++i)
+        d.lookup.key[i] = keys[k][i];
+      t[k] = timeFunc(runLookup, &d.lookup, d.lookup.keys, allocs);
+    }
+    t[2] = timeFunc(runAddRemove, &d, 1, allocs);
+
+    for (int k = 0; k < 3; ++k) {
+      if (!s) first[k] = t[k];
+      last[k] = t[k];
+    }
+    printf("  %6d modules: %8.1f / %8.1f  %8.1f  (%ld)\n",
+           n, t[0], t[1], t[2], allocs);
+
+    for (int m = 0; m <= n; ++m)
+      delete module[m];
+    delete [] module;
+  } // end for each size
+
+  checkScaling("module lookup", first[0], last[0]);
+  checkScaling("module abbreviation", first[1], last[1]);
+  checkScaling("module add", first[2], last[2]);
+} // end benchModules
+
+//====================================================================
+// Re-parsing as the last word is typed:
+//
+// The command line is n words checked in order (by a returningAll
+// option), and the last one is retyped a keystroke at a time.  Each
+// keystroke is timed both as a new process and as a restore to the
+// checkpoint before the last word, which should not depend on n.
+//--------------------------------------------------------------------
+
+struct RestoreData
+{
+  ProcessData         process;
+  GetOpt::Checkpoint  saved;
+}; // end RestoreData
+
+static const char* const  typing[] = {
+  "f", "fi", "fil", "file", "-", "--", "--a", "--al", "--alpha"
+};
+static const int  keystrokes = sizeof(typing) / sizeof(typing[0]);
+
+static void runRetype(void* data)
+{
+  ProcessData&  d = *static_cast<ProcessData*>(data);
+
+  for (int i = 0; i < keystrokes; ++i) {
+    d.args[d.argc - 1] = typing[i];
+    runProcess(&d);
+  }
+} // end runRetype
+
+static void runRestore(void* data)
+{
+  RestoreData&    d = *static_cast<RestoreData*>(data);
+  GetOpt::Event  event;
+
+  for (int i = 0; i < keystrokes; ++i) {
+    d.process.argv[d.process.argc - 1] = typing[i];
+    d.process.getopt->restore(d.saved, d.process.argc, d.process.argv);
+    while (d.process.getopt->nextOption(event))
+      ;
+  }
+} // end runRestore
+
+static void benchRestore()
+{
+  static const int  sizes[] = { 10, 1000, 100000 };
+  static const int  numSizes = sizeof(sizes) / sizeof(sizes[0]);
+  static const GetOpt::Option  options[] = {
+    { 'a', "alpha", NULL, GetOpt::repeatable, NULL, NULL },
+    { 'n', "name",  NULL, GetOpt::needArg | GetOpt::repeatable,
+      GetOpt::isString, NULL },
+    { 0,   "",      NULL, GetOpt::repeatable, NULL, NULL },
+    { 0 }
+  };
+  static const char* const  words[] = { "--alpha", "-n", "value", "file" };
+
+  printf("restore: ns/keystroke (process / restore)\n");
+
+  double  first = 0, last = 0;
+
+  for (int s = 0; s < numSizes; ++s) {
+    const int    n = sizes[s];
+    RestoreData  d;
+    GetOpt       getopt(options);
+
+    d.process.args = new const char*[n + 1];
+    d.process.argv = new const char*[n + 1];
+    d.process.args[0] = "bench";
+    for (int i = 1; i <= n; ++i)
+      d.process.args[i] = words[(i - 1) % 4];
+    d.process.argc = n + 1;
+    d.process.getopt = &getopt;
+
+    long  allocs;
+    const double  full = timeFunc(runRetype, &d.process, keystrokes, allocs);
+
+    // Parse up to the last word, and save the place:
+    GetOpt::Event  event;
+    memcpy(d.process.argv, d.process.args, n * sizeof(*d.process.argv));
+    d.process.argv[n] = typing[0];
+    getopt.init(d.process.argc, d.process.argv);
+    while (getopt.checkpoint(d.saved) < n && getopt.nextOption(event))
+      ;
+
+    last = timeFunc(runRestore, &d, keystrokes, allocs);
+    if (!first) first = last;
+
+    printf("  %6d words: %10.2f / %8.2f  (%ld)\n", n, full, last, allocs);
+
+    delete [] d.process.argv;
+    delete [] d.process.args;
+  } // end for each size
+
+  checkScaling("restore", first, last);
+} // end benchRestore
+
+//====================================================================
+// Main program:
+//
+// Returns 1 if anything that should take constant time per argument
+// (or per lookup) does not.
+
+int main()
+{
+  benchLookup();
+  benchProcess();
+  benchBundles();
+  benchPermute();
+  benchSuggest();
+  benchComplete();
+  benchCommand();
+  benchConvert();
+  benchNumbers();
+  benchRestore();
+  benchModules();
+
+  return status;
+} // end main
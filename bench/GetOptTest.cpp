@@ -0,0 +1,713 @@
+//--------------------------------------------------------------------
+//   Free GetOpt regression tests
+//
+//   Copyright 2000 by Christopher J. Madsen
+//   See GetOpt.cpp for license information
+//
+//   Check GetOpt on inputs that once went wrong
+//
+//--------------------------------------------------------------------
+//
+// Build and run with "make -C bench test".  Each test prints a line
+// for each check that fails, and the program exits with status 1 if
+// any did.  They're worth running under AddressSanitizer, too:
+//
+//   make -C bench test CXXFLAGS="-g -fsanitize=address"
+//
+//--------------------------------------------------------------------
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../GetOpt.hpp"
+
+static int  status = 0;         // The exit status
+
+//--------------------------------------------------------------------
+// Record a check:
+
+static void check(const char* test, bool ok, const char* what)
+{
+  if (!ok) {
+    printf("%s: FAILED: %s\n", test, what);
+    status = 1;
+  }
+} // end check
+
+//--------------------------------------------------------------------
+// Make a pipe with text already written to it:
+//
+// The text must fit in the pipe's buffer.  Returns the end to read,
+// or -1 if the pipe couldn't be made.
+
+static int pipeOf(const char* text, size_t length)
+{
+  int  fd[2];
+
+  if (pipe(fd) != 0) return -1;
+
+  if (write(fd[1], text, length) != static_cast<ssize_t>(length)) {
+    close(fd[0]);
+    fd[0] = -1;
+  }
+  close(fd[1]);
+
+  return fd[0];
+} // end pipeOf
+
+//====================================================================
+// StreamSource with a tiny window:
+//
+// An option and its argument are read one after the other, and the
+// option text must still be there when the callback gets both, even
+// though the argument won't fit in the window with it.
+//--------------------------------------------------------------------
+
+struct StreamSeen
+{
+  char  text[512];
+  int   length;
+}; // end StreamSeen
+
+static bool seeOutput(GetOpt* getopt, const GetOpt::Option* option,
+                      const char* asEntered, GetOpt::Connection,
+                      const char* argument, int*)
+{
+  StreamSeen*  seen = static_cast<StreamSeen*>(getopt->optionData(option));
+
+  seen->length += snprintf(seen->text + seen->length,
+                           sizeof(seen->text) - seen->length,
+                           "%s=%s;", asEntered, argument ? argument : "");
+  return true;
+} // end seeOutput
+
+static bool readStream(GetOpt* getopt, const GetOpt::Option* option,
+                       const char*, GetOpt::Connection, const char*, int*)
+{
+  const int*  fd = static_cast<const int*>(getopt->optionData(option));
+
+  getopt->pushSource(new GetOpt::StreamSource(*fd, 0, 16));
+  return true;
+} // end readStream
+
+static bool readLines(GetOpt* getopt, const GetOpt::Option* option,
+                      const char*, GetOpt::Connection, const char*, int*)
+{
+  const int*  fd = static_cast<const int*>(getopt->optionData(option));
+
+  getopt->pushSource(new GetOpt::StreamSource(*fd, '\n', 16));
+  return true;
+} // end readLines
+
+static void testStreamWindow()
+{
+  static const char  input[] =
+    "--output\0valuevaluevaluevalue\0"
+    "--output\0x\0"
+    "--output\0a-much-longer-value-than-the-window-holds\0"
+    "-o\0short\0"
+    "--output\0valuevaluevaluevalue";
+  static const char  expected[] =
+    "--output=valuevaluevaluevalue;"
+    "--output=x;"
+    "--output=a-much-longer-value-than-the-window-holds;"
+    "-o=short;"
+    "--output=valuevaluevaluevalue;";
+
+  int  fd = pipeOf(input, sizeof(input) - 1);
+  check("stream", fd >= 0, "can't make a pipe");
+  if (fd < 0) return;
+
+  StreamSeen  seen;
+  seen.length  = 0;
+  seen.text[0] = '\0';
+
+  GetOpt::Found  output, stream;
+  const GetOpt::Option  options[] = {
+    { 'o', "output", &output, GetOpt::needArg | GetOpt::repeatable,
+      seeOutput, &seen },
+    { 0, "stream", &stream, 0, readStream, &fd },
+    { 0 }
+  };
+  const char*  args[] = { "test", "--stream" };
+
+  GetOpt  getopt(options);
+  getopt.errorOutput = NULL;
+  getopt.process(2, args);
+
+  check("stream", !getopt.error, "reported an error");
+  check("stream", strcmp(seen.text, expected) == 0, seen.text);
+
+  close(fd);
+} // end testStreamWindow
+
+//====================================================================
+// Parallel conversion with a StreamSource:
+//
+// The arguments from a StreamSource are gone by the time the deferred
+// callbacks would run, so they must be converted right away.
+//--------------------------------------------------------------------
+
+static void testStreamDeferred()
+{
+  static const char  input[] =
+    "--val\naaaa\n--val\nbbbb\n--val\ncccc\n--val\ndddd\n";
+  static const char  expected[] =
+    "--val=aaaa;--val=bbbb;--val=cccc;--val=dddd;";
+
+  int  fd = pipeOf(input, sizeof(input) - 1);
+  check("deferred stream", fd >= 0, "can't make a pipe");
+  if (fd < 0) return;
+
+  StreamSeen  seen;
+  seen.length  = 0;
+  seen.text[0] = '\0';
+
+  GetOpt::Found  val, stream;
+  const GetOpt::Option  options[] = {
+    { 0, "val", &val,
+      GetOpt::needArg | GetOpt::repeatable | GetOpt::concurrent,
+      seeOutput, &seen },
+    { 0, "stdin", &stream, 0, readLines, &fd },
+    { 0 }
+  };
+  const char*  args[] = { "test", "--stdin" };
+
+  GetOpt  getopt(options);
+  getopt.errorOutput = NULL;
+  getopt.conversionThreads = 2;
+  getopt.process(2, args);
+
+  check("deferred stream", !getopt.error, "reported an error");
+  check("deferred stream", strcmp(seen.text, expected) == 0, seen.text);
+
+  close(fd);
+} // end testStreamDeferred
+
+//====================================================================
+// Parallel conversion of callbacks:
+//
+// Only a concurrent callback is called on other threads, so isLong
+// keeps the last occurrence.  A concurrent callback is called once
+// for each occurrence, even if it fails, and its errors are reported
+// in the order of the command line.
+//--------------------------------------------------------------------
+
+static int  checkCalls = 0;
+
+static bool rejectFours(GetOpt* getopt, const GetOpt::Option*,
+                        const char* asEntered, GetOpt::Connection,
+                        const char* argument, int*)
+{
+  __sync_fetch_and_add(&checkCalls, 1);
+
+  if (atoi(argument) % 4) return true;
+
+  getopt->reportError(asEntered, " is a multiple of 4");
+  return false;
+} // end rejectFours
+
+static void testConcurrent()
+{
+  static const int  n = 200;
+  static char       text[n][8];
+  const char*       args[2 * n + 1];
+  long              number = 0;
+
+  GetOpt::Found  numberFound, checkFound;
+  const GetOpt::Option  options[] = {
+    { 'n', "number", &numberFound, GetOpt::needArg | GetOpt::repeatable,
+      GetOpt::isLong, &number },
+    { 'c', "check", &checkFound,
+      GetOpt::needArg | GetOpt::repeatable | GetOpt::concurrent,
+      rejectFours, NULL },
+    { 0 }
+  };
+
+  args[0] = "test";
+  for (int i = 0; i < n; ++i) {
+    sprintf(text[i], "%d", i + 1);
+    args[2 * i + 1] = (i % 2) ? "--check" : "--number";
+    args[2 * i + 2] = text[i];
+  }
+
+  GetOpt::ErrorRecord  errors[n];
+  GetOpt  getopt(options);
+  getopt.errorOutput       = NULL;
+  getopt.errorList         = errors;
+  getopt.errorListSize     = n;
+  getopt.conversionThreads = 4;
+  getopt.process(2 * n + 1, args);
+
+  check("concurrent", number == n - 1, "isLong didn't keep the last number");
+  check("concurrent", checkCalls == n / 2,
+        "the callback wasn't called once per occurrence");
+  check("concurrent", getopt.errorCount == n / 4, "wrong number of errors");
+
+  bool  inOrder = true;
+  for (int i = 0; i < getopt.errorCount && i < n; ++i)
+    if (errors[i].code != GetOpt::invalidArgument ||
+        errors[i].position != 8 * i + 7)
+      inOrder = false;
+  check("concurrent", inOrder, "errors out of order");
+} // end testConcurrent
+
+//====================================================================
+// Held errors mixed with others:
+//
+// The errors held for deferred callbacks must be merged in command
+// line order with the ones reported while parsing, and an occurrence
+// whose callback failed must be removed.
+//--------------------------------------------------------------------
+
+static void testConcurrentErrors()
+{
+  static const int  groups = 40;
+  static const int  perGroup = 7;
+  const char*       args[groups * perGroup + 1];
+  long              number = 0;
+
+  GetOpt::Found  numberFound, checkFound;
+  const GetOpt::Option  options[] = {
+    { 'n', "number", &numberFound, GetOpt::needArg | GetOpt::repeatable,
+      GetOpt::isLong, &number },
+    { 'c', "check", &checkFound,
+      GetOpt::needArg | GetOpt::repeatable | GetOpt::concurrent |
+      GetOpt::capture, rejectFours, NULL },
+    { 0 }
+  };
+
+  // Each group: a held error, two errors found while parsing, and a
+  // deferred callback that succeeds.
+  args[0] = "test";
+  for (int g = 0; g < groups; ++g) {
+    const char**  a = args + g * perGroup + 1;
+    a[0] = "--check";  a[1] = "8";
+    a[2] = "--number"; a[3] = "x";
+    a[4] = "--bogus";
+    a[5] = "--check";  a[6] = "5";
+  }
+
+  GetOpt::ErrorRecord  errors[3 * groups];
+  GetOpt  getopt(options);
+  getopt.errorOutput       = NULL;
+  getopt.errorList         = errors;
+  getopt.errorListSize     = 3 * groups;
+  getopt.conversionThreads = 4;
+  getopt.process(groups * perGroup + 1, args);
+
+  check("concurrent errors", getopt.errorCount == 3 * groups,
+        "wrong number of errors");
+
+  static const GetOpt::ErrorCode  code[] = {
+    GetOpt::invalidArgument, GetOpt::invalidArgument, GetOpt::unknownOption
+  };
+  static const int  offset[] = { 1, 3, 5 };
+
+  bool  inOrder = true;
+  for (int i = 0; i < getopt.errorCount && i < 3 * groups; ++i)
+    if (errors[i].code != code[i % 3] ||
+        errors[i].position != (i / 3) * perGroup + offset[i % 3])
+      inOrder = false;
+  check("concurrent errors", inOrder, "errors out of order");
+
+  GetOpt::Occurrences  found = getopt.occurrences(options + 1);
+  check("concurrent errors", found.size() == groups,
+        "failed occurrences weren't removed");
+  for (int i = 0; i < found.size(); ++i)
+    if (strcmp(found.first[i].argument, "5") != 0 ||
+        found.first[i].position != i * perGroup + 6) {
+      check("concurrent errors", false, "wrong occurrence kept");
+      break;
+    }
+} // end testConcurrentErrors
+
+//====================================================================
+// Response files that can't be mapped:
+//
+// A pipe (like @/dev/stdin) is read instead, with the same results
+// as a regular file.
+//--------------------------------------------------------------------
+
+static void testResponsePipe()
+{
+  static const char  input[] =
+    "--output x -o 'two words'\n--output \"y\\\"z\"";
+  static const char  expected[] =
+    "--output=x;-o=two words;--output=y\"z;";
+
+  int  fd = pipeOf(input, sizeof(input) - 1);
+  check("response pipe", fd >= 0, "can't make a pipe");
+  if (fd < 0) return;
+
+  StreamSeen  seen;
+  seen.length  = 0;
+  seen.text[0] = '\0';
+
+  GetOpt::Found  output;
+  const GetOpt::Option  options[] = {
+    { 'o', "output", &output, GetOpt::needArg | GetOpt::repeatable,
+      seeOutput, &seen },
+    { 0 }
+  };
+  char         file[32];
+  const char*  args[] = { "test", file };
+  sprintf(file, "@/dev/fd/%d", fd);
+
+  GetOpt  getopt(options);
+  getopt.errorOutput = NULL;
+  getopt.responseFileStart = '@';
+  getopt.process(2, args);
+
+  check("response pipe", !getopt.error, "reported an error");
+  check("response pipe", strcmp(seen.text, expected) == 0, seen.text);
+
+  close(fd);
+} // end testResponsePipe
+
+//====================================================================
+// Response files:
+//
+// Arguments are ended and unquoted in place in the private mapping,
+// including one longer than a page.  All of them must stay valid
+// until the next init.
+//--------------------------------------------------------------------
+
+static void testResponseFile()
+{
+  static const int  longLength = 100000;
+  static char       longArg[longLength + 1];
+  static const char  head[] =
+    "--output\0plain\0--output\0'quoted one'\0-o spaced\n"
+    "--output \"";
+  static const char  tail[] = "\" --output\0end";
+
+  char  file[] = "/tmp/GetOptTestXXXXXX";
+  int   fd = mkstemp(file);
+  check("response file", fd >= 0, "can't make a file");
+  if (fd < 0) return;
+
+  memset(longArg, 'x', longLength);
+  const bool  written =
+    (write(fd, head, sizeof(head) - 1) == ssize_t(sizeof(head) - 1) &&
+     write(fd, longArg, longLength) == ssize_t(longLength) &&
+     write(fd, tail, sizeof(tail) - 1) == ssize_t(sizeof(tail) - 1));
+  close(fd);
+  check("response file", written, "can't write the file");
+
+  GetOpt::Found  output;
+  const GetOpt::Option  options[] = {
+    { 'o', "output", &output,
+      GetOpt::needArg | GetOpt::repeatable | GetOpt::capture, NULL, NULL },
+    { 0 }
+  };
+  char         name[sizeof(file) + 1];
+  const char*  args[] = { "test", name };
+  sprintf(name, "@%s", file);
+
+  GetOpt  getopt(options);
+  getopt.errorOutput = NULL;
+  getopt.responseFileStart = '@';
+  getopt.process(2, args);
+  unlink(file);
+
+  const char*  expected[] = {
+    "plain", "quoted one", "spaced", NULL, "end"
+  };
+  const int  count = sizeof(expected) / sizeof(expected[0]);
+  expected[3] = longArg;
+
+  check("response file", !getopt.error, "reported an error");
+
+  GetOpt::Occurrences  found = getopt.occurrences(options);
+  check("response file", found.size() == count, "wrong number of arguments");
+  for (int i = 0; i < found.size() && i < count; ++i)
+    check("response file", strcmp(found.first[i].argument, expected[i]) == 0,
+          found.first[i].argument);
+} // end testResponseFile
+
+//====================================================================
+// Normal arguments in a response file:
+//
+// They can't go into argv, but positionals must return them where
+// they were on the command line, with or without rearranging argv.
+//--------------------------------------------------------------------
+
+static void testResponsePositionals()
+{
+  static const char  text[] = "x --output o1 y\n-v 'z z'";
+
+  char  file[] = "/tmp/GetOptTestXXXXXX";
+  int   fd = mkstemp(file);
+  check("response positionals", fd >= 0, "can't make a file");
+  if (fd < 0) return;
+
+  const bool  written =
+    (write(fd, text, sizeof(text) - 1) == ssize_t(sizeof(text) - 1));
+  close(fd);
+  check("response positionals", written, "can't write the file");
+
+  GetOpt::Found  output, verbose;
+  const GetOpt::Option  options[] = {
+    { 'o', "output",  &output,  GetOpt::needArg | GetOpt::capture,
+      NULL, NULL },
+    { 'v', "verbose", &verbose, GetOpt::repeatable, NULL, NULL },
+    { 0 }
+  };
+  char         name[sizeof(file) + 1];
+  const char*  args[] = { "test", "a", name, "b", "-v", "c" };
+  const int    argCount = sizeof(args) / sizeof(args[0]);
+  sprintf(name, "@%s", file);
+
+  static const char* const  expected[] = { "a", "x", "y", "z z", "b", "c" };
+  const int  count = sizeof(expected) / sizeof(expected[0]);
+
+  GetOpt  getopt(options);
+  getopt.errorOutput = NULL;
+  getopt.responseFileStart = '@';
+
+  for (int pass = 0; pass < 2; ++pass) {
+    const char*  argv[argCount];
+    int          order[argCount];
+    memcpy(argv, args, sizeof(args));
+
+    const int  first = pass ? getopt.process(argCount, args, order)
+                            : getopt.process(argCount, argv);
+
+    check("response positionals", !getopt.error, "reported an error");
+    GetOpt::Occurrences  found = getopt.occurrences(options);
+    check("response positionals", found.size() == 1 &&
+          strcmp(found.first[0].argument, "o1") == 0, "lost --output");
+    check("response positionals", verbose == GetOpt::noArg, "lost -v");
+    check("response positionals", first == argCount - 3,
+          "wrong first normal argument in argv");
+
+    const char* const*  list;
+    const int           n = getopt.positionals(list);
+    check("response positionals", n == count, "wrong number of arguments");
+    for (int i = 0; i < n && i < count; ++i)
+      check("response positionals", strcmp(list[i], expected[i]) == 0,
+            list[i]);
+  } // end for with and without order
+
+  unlink(file);
+} // end testResponsePositionals
+
+//====================================================================
+// Lazy queries:
+//
+// has and value must find the same options that process does,
+// including "---format" for --output-format (where the first '-'
+// stands for the segment "output").
+//--------------------------------------------------------------------
+
+static void testLazyQueries()
+{
+  static const char* const  commandLine[][3] = {
+    { "test", "--output-format=json", "json" },
+    { "test", "---format=yaml",       "yaml" },
+    { "test", "--o-f=csv",            "csv"  },
+    { "test", "--format=xml",         NULL   }
+  };
+
+  GetOpt::Found  format, verbose;
+  const GetOpt::Option  options[] = {
+    { 0,   "output-format", &format,  GetOpt::needArg | GetOpt::capture,
+      NULL, NULL },
+    { 'v', "verbose",       &verbose, 0, NULL, NULL },
+    { 0 }
+  };
+
+  GetOpt  getopt(options);
+  getopt.errorOutput = NULL;
+
+  for (unsigned i = 0; i < sizeof(commandLine) / sizeof(commandLine[0]);
+       ++i) {
+    const char* const*  args  = commandLine[i];
+    const char*         want  = args[2];
+
+    getopt.scan(2, args);
+    const char*  value = getopt.value(options);
+    const bool   ok = (getopt.has(options) == (want != NULL) &&
+                       (want ? (value && strcmp(value, want) == 0) : !value));
+    check("lazy", ok, args[1]);
+  }
+} // end testLazyQueries
+
+//====================================================================
+// Results kept apart from the option list:
+//
+// Only options with the inResults flag store into results.  One
+// without it and with NULL data stores nothing, even though offset 0
+// is a real place in results.
+//--------------------------------------------------------------------
+
+struct Results
+{
+  const char*  name;
+  int64_t      count;
+}; // end Results
+
+static void testResults()
+{
+  GetOpt::Found  name, quiet, count;
+  const GetOpt::Option  options[] = {
+    { 'n', "name",  &name,  GetOpt::needArg | GetOpt::inResults,
+      GetOpt::isString, reinterpret_cast<void*>(offsetof(Results, name)) },
+    { 'q', "quiet", &quiet, GetOpt::needArg, GetOpt::isString, NULL },
+    { 'c', "count", &count, GetOpt::needArg | GetOpt::inResults,
+      GetOpt::isInt64, reinterpret_cast<void*>(offsetof(Results, count)) },
+    { 0 }
+  };
+  const char*  args[] = { "test", "-n", "first", "-q", "x", "-c", "5" };
+
+  Results  results = { NULL, 0 };
+  GetOpt   getopt(options);
+  getopt.errorOutput = NULL;
+  getopt.results = &results;
+  getopt.process(sizeof(args) / sizeof(args[0]), args);
+
+  check("results", !getopt.error, "reported an error");
+  check("results", quiet == GetOpt::withArg, "lost -q");
+  check("results", results.name && strcmp(results.name, "first") == 0,
+        "-q stored into results");
+  check("results", results.count == 5, "-c didn't store into results");
+} // end testResults
+
+//====================================================================
+// Checkpoints:
+//
+// Restoring a checkpoint taken after a normal argument was set aside,
+// with only the arguments after it replaced, must leave argv, the
+// occurrences and the found flags just as parsing the new command
+// line from the start does.
+//--------------------------------------------------------------------
+
+static const int  maxParsed = 8; // Arguments and occurrences
+
+struct Parsed
+{
+  const char*         argv[maxParsed];
+  int                 firstArg;
+  int                 count;
+  GetOpt::Occurrence  occurrence[maxParsed];
+  GetOpt::Found       all, bee;
+}; // end Parsed
+
+static GetOpt::Found  cpAll, cpBee;
+
+static void recordParse(GetOpt& getopt, const char** argv, int argc,
+                        Parsed& parsed)
+{
+  GetOpt::Occurrences  found = getopt.occurrences();
+
+  memcpy(parsed.argv, argv, argc * sizeof(*argv));
+  parsed.firstArg = getopt.currentArg();
+  parsed.count    = found.size();
+  for (int i = 0; i < found.size() && i < maxParsed; ++i)
+    parsed.occurrence[i] = found.first[i];
+  parsed.all = cpAll;
+  parsed.bee = cpBee;
+} // end recordParse
+
+static void testCheckpoint()
+{
+  const GetOpt::Option  options[] = {
+    { 'a', "all", &cpAll, GetOpt::repeatable | GetOpt::capture, NULL, NULL },
+    { 'b', "bee", &cpBee,
+      GetOpt::needArg | GetOpt::repeatable | GetOpt::capture, NULL, NULL },
+    { 0 }
+  };
+  static const char* const  before[] = { "test", "x", "-a", "y", "-b", "1" };
+  static const char* const  after[]  = {
+    "test", "x", "-a", "-b", "2", "w", "-a", "v"
+  };
+  const int  beforeCount = sizeof(before) / sizeof(before[0]);
+  const int  afterCount  = sizeof(after) / sizeof(after[0]);
+  const int  changed     = 3;
+
+  GetOpt               getopt(options);
+  GetOpt::Event        event;
+  GetOpt::Checkpoint   saved, latest;
+  int                  first = -1;
+  const char*          argv[afterCount];
+
+  getopt.errorOutput = NULL;
+
+  memcpy(argv, before, sizeof(before));
+  getopt.init(beforeCount, argv);
+  while (getopt.nextOption(event)) {
+    const int  unread = getopt.checkpoint(latest);
+    if (unread >= 0 && unread <= changed) {
+      saved = latest;
+      first = unread;
+    }
+  }
+  check("checkpoint", first == changed, "no checkpoint after -a");
+  check("checkpoint", argv[1] == before[2], "x wasn't set aside");
+  if (first != changed) return;
+
+  // Keep the arguments before first as they were arranged:
+  int  argc;
+  for (argc = first; argc < afterCount; ++argc)
+    argv[argc] = after[argc];
+  getopt.restore(saved, argc, argv);
+  while (getopt.nextOption(event))
+    ;
+
+  Parsed  restored, full;
+  recordParse(getopt, argv, argc, restored);
+
+  const char*  fresh[afterCount];
+  memcpy(fresh, after, sizeof(after));
+  getopt.init(afterCount, fresh);
+  while (getopt.nextOption(event))
+    ;
+  recordParse(getopt, fresh, afterCount, full);
+
+  for (int i = 0; i < afterCount; ++i)
+    check("checkpoint", strcmp(restored.argv[i], full.argv[i]) == 0,
+          "argv differs from a full parse");
+  check("checkpoint", restored.firstArg == full.firstArg,
+        "different first normal argument");
+  check("checkpoint", restored.all == full.all && restored.bee == full.bee,
+        "different found flags");
+  check("checkpoint", restored.count == full.count,
+        "different number of occurrences");
+  for (int i = 0; i < restored.count && i < full.count && i < maxParsed;
+       ++i) {
+    const GetOpt::Occurrence&  r = restored.occurrence[i];
+    const GetOpt::Occurrence&  f = full.occurrence[i];
+    check("checkpoint", (r.option == f.option && r.position == f.position &&
+                         ((!r.argument && !f.argument) ||
+                          (r.argument && f.argument &&
+                           strcmp(r.argument, f.argument) == 0))),
+          "different occurrence");
+  }
+} // end testCheckpoint
+
+//====================================================================
+// Main program:
+//
+// Returns 1 if any check failed.
+
+int main()
+{
+  testStreamWindow();
+  testStreamDeferred();
+  testConcurrent();
+  testConcurrentErrors();
+  testResponsePipe();
+  testResponseFile();
+  testResponsePositionals();
+  testLazyQueries();
+  testResults();
+  testCheckpoint();
+
+  if (!status) puts("all tests passed");
+
+  return status;
+} // end main
@@ -0,0 +1,133 @@
+#---------------------------------------------------------------------
+# Find the worst-case stack use of functions from a GCC call graph
+#
+#   awk -v roots="SYMBOL..." -v budget=BYTES [-v depth=LEVELS] \
+#       -f stackuse.awk FILE.ci
+#
+# FILE.ci is written by compiling with -fcallgraph-info=su (GCC 10 or
+# later).  For each root (a mangled function name), this prints the
+# deepest chain of calls below it and the stack that chain uses, and
+# exits with status 1 if any root uses more than budget bytes.
+#
+# A call that recurses can only be counted if the recursion has a
+# bound: depth is the most levels it can go below the first call.
+# Each cycle of calls is then charged depth times its biggest frame,
+# where the walk first enters it.  (GetOpt's recursive walks go down
+# its prefix tree one node at a time, so depth is the length of the
+# longest long name.)  Recursion without a depth, or a frame with no
+# bound, makes the total meaningless, so it fails instead.
+#
+# The graph covers only one translation unit, so what it can't see
+# counts as nothing: functions in other files (like memcpy and
+# operator new) and indirect calls (callbacks, errorOutput, and
+# ArgSource::read).  Those are reported, but don't fail.
+#---------------------------------------------------------------------
+
+# Return the text between the quotes that follow key:
+function field(line, key,    start, rest)
+{
+  start = index(line, key "\"")
+  if (!start) return ""
+  rest = substr(line, start + length(key) + 1)
+  return substr(rest, 1, index(rest, "\"") - 1)
+}
+
+/^node:/ {
+  name = field($0, "title: ")
+  label = field($0, "label: ")
+  shown[name] = name
+  if (index(label, "\\n")) shown[name] = substr(label, 1, index(label, "\\n") - 1)
+  if (match(label, /[0-9]+ bytes \(/)) {
+    frame[name] = substr(label, RSTART, RLENGTH) + 0
+    if (index(label, "bytes (dynamic)")) unbounded[name] = 1
+  }
+  next
+}
+
+/^edge:/ {
+  from = field($0, "sourcename: ")
+  to = field($0, "targetname: ")
+  if (to == "__indirect_call") { indirect[from] = 1; next }
+  if (!((from, to) in seen)) {
+    seen[from, to] = 1
+    callee[from, ++calls[from]] = to
+  }
+  next
+}
+
+# Note a call from n back to to, which is already on the path, as a
+# cycle starting at to (charged to it by worst):
+function recurse(to,    i, biggest)
+{
+  biggest = 0
+  for (i = pathLength; path[i] != to; --i)
+    if (frame[path[i]] > biggest) biggest = frame[path[i]]
+  if (frame[to] > biggest) biggest = frame[to]
+
+  recursive[to] = 1
+  if (biggest > cycleFrame[to]) cycleFrame[to] = biggest
+}
+
+# Return the most stack used by a call to n (memoized in deepest):
+function worst(n,    i, to, w, best)
+{
+  if (n in deepest) return deepest[n]
+  if (onStack[n]) { recurse(n); return 0 }
+
+  onStack[n] = 1
+  path[++pathLength] = n
+  best = 0
+  for (i = 1; i <= calls[n]; ++i) {
+    to = callee[n, i]
+    w = worst(to)
+    if (w > best) { best = w; deepestCall[n] = to }
+  }
+  --pathLength
+  onStack[n] = 0
+
+  if (indirect[n]) usesIndirect = 1
+  if (unbounded[n]) hasUnbounded[n] = 1
+  return deepest[n] = frame[n] + best + depth * cycleFrame[n]
+}
+
+END {
+  status = 0
+  count = split(roots, root, " ")
+
+  for (r = 1; r <= count; ++r) {
+    n = root[r]
+    if (!(n in frame)) {
+      printf("stack: %s is not in the call graph\n", n)
+      status = 1
+      continue
+    }
+
+    total = worst(n)
+    printf("stack: %d bytes for %s (budget %d)\n", total, shown[n], budget)
+    for (; n != ""; n = deepestCall[n]) {
+      printf("  %6d  %s\n", frame[n], shown[n])
+      if (cycleFrame[n])
+        printf("  %6d  (%d more levels of recursion, at most %d each)\n",
+               depth * cycleFrame[n], depth, cycleFrame[n])
+    }
+
+    if (total > budget) {
+      printf("stack: OVER BUDGET by %d bytes\n", total - budget)
+      status = 1
+    }
+  } # end for each root
+
+  for (n in recursive)
+    if (!depth) {
+      printf("stack: %s recurses, and depth is not set\n", shown[n])
+      status = 1
+    }
+  for (n in hasUnbounded) {
+    printf("stack: %s has a frame with no bound\n", shown[n])
+    status = 1
+  }
+  if (usesIndirect)
+    print "stack: not counted: callbacks and other indirect calls"
+
+  exit status
+}